@@ -0,0 +1,120 @@
+#include "assetPack.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef ASSET_PACK_EMBEDDED
+// defined by the source the packer generates with --embed
+extern "C" const unsigned char embeddedAssetPack[];
+extern "C" const size_t embeddedAssetPackSize;
+#endif
+
+AssetPack::AssetPack(){
+    this->base = NULL;
+    this->size = 0;
+    this->mapped = false;
+    this->entries = NULL;
+    this->entryCount = 0;
+}
+
+AssetPack::~AssetPack(){
+    this->close();
+}
+
+bool AssetPack::open(const char* path){
+    this->close();
+
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (mapping == MAP_FAILED){
+        std::cout << "ERROR::PACK::CANNOT_MAP " << path << std::endl;
+        return false;
+    }
+
+    this->mapped = true;
+    if (!this->attach(static_cast<const unsigned char*>(mapping), info.st_size)){
+        std::cout << "ERROR::PACK::INVALID_FILE " << path << std::endl;
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+bool AssetPack::openEmbedded(){
+#ifdef ASSET_PACK_EMBEDDED
+    this->close();
+    return this->attach(embeddedAssetPack, embeddedAssetPackSize);
+#else
+    return false;
+#endif
+}
+
+void AssetPack::close(){
+    if (this->mapped && this->base)
+        munmap(const_cast<unsigned char*>(this->base), this->size);
+    this->base = NULL;
+    this->size = 0;
+    this->mapped = false;
+    this->entries = NULL;
+    this->entryCount = 0;
+}
+
+bool AssetPack::isOpen() const{
+    return this->base != NULL;
+}
+
+bool AssetPack::attach(const unsigned char* base, size_t size){
+    this->base = base;
+    this->size = size;
+
+    PackHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, base, sizeof(header));
+    if (header.magic != PACK_MAGIC || header.version != PACK_VERSION)
+        return false;
+    if (header.entryCount > (size - sizeof(header))/sizeof(PackEntry))
+        return false;
+
+    this->entries = reinterpret_cast<const PackEntry*>(base + sizeof(header));
+    this->entryCount = header.entryCount;
+    for (uint32_t i = 0; i<this->entryCount; i++){
+        const PackEntry& entry = this->entries[i];
+        if (entry.offset > size || entry.size > size - entry.offset
+                || entry.name[sizeof(entry.name) - 1] != '\0')
+            return false;
+    }
+    return true;
+}
+
+const PackEntry* AssetPack::find(const std::string& name) const{
+    for (uint32_t i = 0; i<this->entryCount; i++){
+        if (name == this->entries[i].name)
+            return &this->entries[i];
+    }
+    return NULL;
+}
+
+const unsigned char* AssetPack::data(const PackEntry& entry) const{
+    return this->base + entry.offset;
+}
+
+bool AssetPack::text(const std::string& name, std::string& out) const{
+    const PackEntry* entry = this->find(name);
+    if (!entry || entry->kind != PACK_TEXT)
+        return false;
+    out.assign(reinterpret_cast<const char*>(this->data(*entry)), entry->size);
+    return true;
+}
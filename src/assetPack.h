@@ -0,0 +1,109 @@
+#ifndef _ASSET_PACK_H_
+#define _ASSET_PACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Everything the game loads from disk, relative to src/. The packer bakes
+// exactly these; without a pack they are read from the source tree.
+const char* const PACKED_IMAGES[] = {
+    "textures/background.png",
+    "textures/player/playerRun1.png",
+    "textures/player/playerRun2.png",
+    "textures/player/playerRun3.png",
+    "textures/zapper.png",
+    "textures/diagonalZapper.png",
+    "textures/coin.png",
+    "textures/pillar.png",
+    "textures/gameover.png",
+    "textures/gamewin.png"
+};
+const char* const PACKED_SHADERS[] = {
+    "shaders/texture",
+    "shaders/fragment",
+    "fortext/text.vs",
+    "fortext/text.fs"
+};
+const char* const GLYPH_FONT = "/usr/share/fonts/truetype/ubuntu/Ubuntu-B.ttf";
+const int GLYPH_PIXEL_SIZE = 48;    // text scales are per pixel of this size
+const int GLYPH_COUNT = 128;
+// glyphs are distance fields (SdfFont), sampled at a smaller size
+const int GLYPH_SDF_SIZE = 32;
+const int GLYPH_SDF_SPREAD = 4;         // field pixels each side of the outline
+const int GLYPH_SDF_OVERSAMPLE = 4;
+
+// File layout: a PackHeader, the PackEntry table, then every entry's data
+// at an offset aligned to PACK_ALIGNMENT so it can be used in place from
+// a mapping. All values are little endian.
+const uint32_t PACK_MAGIC = 0x4b41504a;     // "JPAK"
+const uint32_t PACK_VERSION = 3;
+const uint64_t PACK_ALIGNMENT = 64;
+
+enum PackKind{
+    PACK_TEXTURE = 1,   // RGBA8 mip chain, largest level first, tightly packed
+    PACK_TEXT = 2,      // shader source, not null terminated
+    PACK_DATA = 3       // array of one of the Pack* records below, or "font/sdf"
+};
+
+struct PackHeader{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry{
+    char name[48];
+    uint32_t kind;
+    uint32_t levels;        // mip levels of a texture
+    uint32_t width;         // of level 0
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// "atlas/regions": one per atlas image, in the atlas' id order
+struct PackRegion{
+    char name[48];          // image path
+    uint32_t page;          // "atlas/page<n>"
+    int32_t x;              // unpadded texel rectangle on the page
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+// "font/sdf": the ASCII glyph fields as written by SdfFont::write
+
+// Read-only view of a pack, memory mapped from a file or embedded in the
+// executable. Entry data stays valid until the pack is closed.
+class AssetPack{
+    public:
+        AssetPack();
+        ~AssetPack();
+
+        bool open(const char* path);
+        // the pack linked in with EMBED_ASSET_PACK, false if there is none
+        bool openEmbedded();
+        void close();
+        bool isOpen() const;
+
+        const PackEntry* find(const std::string& name) const;
+        const unsigned char* data(const PackEntry& entry) const;
+        // shader source by name, false if the pack does not have it
+        bool text(const std::string& name, std::string& out) const;
+
+    private:
+        const unsigned char* base;
+        size_t size;
+        bool mapped;
+        const PackEntry* entries;
+        uint32_t entryCount;
+
+        bool attach(const unsigned char* base, size_t size);
+
+        AssetPack(const AssetPack&);
+        AssetPack& operator=(const AssetPack&);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "atlasLayout.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    struct ByHeight{
+        const std::vector<glm::ivec2>* sizes;
+        bool operator()(int a, int b) const{
+            return (*sizes)[a].y > (*sizes)[b].y;
+        }
+    };
+}
+
+std::vector<glm::ivec2> layoutAtlas(const std::vector<glm::ivec2>& sizes,
+        int pageSize, int padding, std::vector<AtlasPlacement>& placements){
+    std::vector<int> order(sizes.size());
+    for (unsigned int i = 0; i<sizes.size(); i++)
+        order[i] = i;
+    ByHeight byHeight = { &sizes };
+    std::stable_sort(order.begin(), order.end(), byHeight);
+
+    placements.resize(sizes.size());
+    std::vector<glm::ivec2> pageExtent;
+    int page = -1, cursorX = 0, cursorY = 0, shelfHeight = 0;
+    for (unsigned int i = 0; i<order.size(); i++){
+        const glm::ivec2& size = sizes[order[i]];
+        int w = size.x + 2*padding;
+        int h = size.y + 2*padding;
+
+        if (page < 0 || cursorX + w > pageSize){
+            cursorX = 0;
+            cursorY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (page < 0 || cursorY + h > pageSize){
+            if (w > pageSize || h > pageSize)
+                std::cout << "Atlas: image of " << size.x << "x" << size.y
+                    << " exceeds the page size" << std::endl;
+            pageExtent.push_back(glm::ivec2(0, 0));
+            page++;
+            cursorX = cursorY = shelfHeight = 0;
+        }
+
+        AtlasPlacement& placement = placements[order[i]];
+        placement.page = page;
+        placement.x = cursorX + padding;
+        placement.y = cursorY + padding;
+        cursorX += w;
+        shelfHeight = std::max(shelfHeight, h);
+        pageExtent[page] = glm::max(pageExtent[page], glm::ivec2(cursorX, cursorY + h));
+    }
+    return pageExtent;
+}
+
+void downsampleImage(const unsigned char* pixels, int width, int height,
+        std::vector<unsigned char>& out, int& outWidth, int& outHeight){
+    outWidth = std::max(width/2, 1);
+    outHeight = std::max(height/2, 1);
+    out.resize(outWidth*outHeight*4);
+    for (int y = 0; y<outHeight; y++){
+        int y0 = std::min(2*y, height - 1), y1 = std::min(2*y + 1, height - 1);
+        for (int x = 0; x<outWidth; x++){
+            int x0 = std::min(2*x, width - 1), x1 = std::min(2*x + 1, width - 1);
+            for (int c = 0; c<4; c++){
+                int sum = pixels[(y0*width + x0)*4 + c] + pixels[(y0*width + x1)*4 + c]
+                    + pixels[(y1*width + x0)*4 + c] + pixels[(y1*width + x1)*4 + c];
+                out[(y*outWidth + x)*4 + c] = (sum + 2)/4;
+            }
+        }
+    }
+}
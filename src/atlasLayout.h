@@ -0,0 +1,29 @@
+#ifndef _ATLAS_LAYOUT_H_
+#define _ATLAS_LAYOUT_H_
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// defaults shared by the runtime atlas and the asset packer
+const int ATLAS_PAGE_SIZE = 2048;
+const int ATLAS_PADDING = 4;
+
+// where a rectangle went: its page and the top left of its unpadded area
+struct AtlasPlacement{
+    int page;
+    int x;
+    int y;
+};
+
+// Shelf packs rectangles, tallest first, each with padding texels around
+// it. Returns the used width/height of every page. Needs no GL, so the
+// asset packer lays pages out exactly like the runtime atlas does.
+std::vector<glm::ivec2> layoutAtlas(const std::vector<glm::ivec2>& sizes,
+        int pageSize, int padding, std::vector<AtlasPlacement>& placements);
+
+// halves an RGBA image with a 2x2 box filter, odd edges are clamped
+void downsampleImage(const unsigned char* pixels, int width, int height,
+        std::vector<unsigned char>& out, int& outWidth, int& outHeight);
+
+#endif
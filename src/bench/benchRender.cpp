@@ -0,0 +1,298 @@
+// Renders the game scene offscreen and reports its throughput, to catch
+// render regressions without a window or a GPU (Mesa llvmpipe works).
+//
+//   bench_render [--zappers N] [--coins N] [--hud N] [--frames N] [--warmup N]
+//                [--width W] [--height H] [--pack FILE] [--root DIR] [--out FILE]
+//
+// The context is EGL surfaceless and draws into a framebuffer object of the
+// given size. Sprites and text go through the same Scene, SpriteBatch and
+// TextBatch as the game. Every frame ends with glFinish(), standing in for
+// the swap. Results are printed as JSON, and written to --out if given.
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stb_image.h>
+
+#include "scene.h"
+#include "random.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BenchOptions{
+    unsigned int zappers;
+    unsigned int coins;
+    unsigned int hud;       // HUD lines
+    unsigned int frames;
+    unsigned int warmup;
+    int width;
+    int height;
+    const char* packPath;
+    const char* root;
+    const char* outPath;
+};
+
+// one sprite of the synthetic level
+struct BenchSprite{
+    const SpriteShape* shape;
+    const AtlasRegion* texture;
+    glm::vec3 position;
+    unsigned int variant;
+};
+
+// core 3.3 context without any surface, on the surfaceless platform if
+// the driver has it
+static bool createContext(EGLDisplay& display, EGLContext& context){
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    display = EGL_NO_DISPLAY;
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)
+            || !eglBindAPI(EGL_OPENGL_API))
+        return false;
+
+    const EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    return context != EGL_NO_CONTEXT
+        && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+// the default framebuffer of a surfaceless context is incomplete
+static bool createFramebuffer(int width, int height, unsigned int& framebuffer,
+        unsigned int& colorBuffer){
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glViewport(0, 0, width, height);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// x in [0, length)
+static float wrap(float x, float length){
+    x = fmodf(x, length);
+    return x < 0.0f ? x + length : x;
+}
+
+static std::string jsonString(const char* text){
+    std::string out = "\"";
+    for (; text && *text; text++){
+        if (*text == '"' || *text == '\\')
+            out += '\\';
+        out += *text;
+    }
+    return out + "\"";
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options){
+    options.zappers = 200;
+    options.coins = 400;
+    options.hud = 8;
+    options.frames = 300;
+    options.warmup = 30;
+    options.width = 2500;
+    options.height = 1500;
+    options.packPath = "assets.pack";
+    options.root = "../src/";
+    options.outPath = NULL;
+
+    for (int i = 1; i<argc; i++){
+        if (i + 1 >= argc)
+            return false;
+        const char* value = argv[i + 1];
+        if (!strcmp(argv[i], "--zappers"))
+            options.zappers = strtoul(value, NULL, 10);
+        else if (!strcmp(argv[i], "--coins"))
+            options.coins = strtoul(value, NULL, 10);
+        else if (!strcmp(argv[i], "--hud"))
+            options.hud = strtoul(value, NULL, 10);
+        else if (!strcmp(argv[i], "--frames"))
+            options.frames = strtoul(value, NULL, 10);
+        else if (!strcmp(argv[i], "--warmup"))
+            options.warmup = strtoul(value, NULL, 10);
+        else if (!strcmp(argv[i], "--width"))
+            options.width = atoi(value);
+        else if (!strcmp(argv[i], "--height"))
+            options.height = atoi(value);
+        else if (!strcmp(argv[i], "--pack"))
+            options.packPath = value;
+        else if (!strcmp(argv[i], "--root"))
+            options.root = value;
+        else if (!strcmp(argv[i], "--out"))
+            options.outPath = value;
+        else
+            return false;
+        i++;
+    }
+    return options.frames > 0 && options.width > 0 && options.height > 0;
+}
+
+int main(int argc, char** argv){
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)){
+        fprintf(stderr, "usage: %s [--zappers N] [--coins N] [--hud N] [--frames N] [--warmup N]\n"
+            "       [--width W] [--height H] [--pack FILE] [--root DIR] [--out FILE]\n", argv[0]);
+        return 2;
+    }
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!createContext(display, context)){
+        fprintf(stderr, "bench_render: no EGL OpenGL 3.3 core context\n");
+        return 1;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)){
+        fprintf(stderr, "bench_render: failed to initialize GLAD\n");
+        return 1;
+    }
+    unsigned int framebuffer, colorBuffer;
+    if (!createFramebuffer(options.width, options.height, framebuffer, colorBuffer)){
+        fprintf(stderr, "bench_render: incomplete framebuffer\n");
+        return 1;
+    }
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    stbi_set_flip_vertically_on_load(true);
+
+    // the scene's GL objects are deleted when this block closes, while the
+    // context is still current
+    {
+        // same setup as the game
+        ResourceManager resources;
+        AssetPack pack;
+        if (!pack.openEmbedded())
+            pack.open(options.packPath);
+        TextureAtlas atlas(resources, ATLAS_PAGE_SIZE, ATLAS_PADDING, options.root);
+        if (pack.isOpen())
+            atlas.load(pack);
+        float aspect = static_cast<float>(options.width)/static_cast<float>(options.height);
+        Scene scene(pack, atlas, resources, aspect, options.root);
+        if (!scene.glyphsLoaded)
+            return 1;
+        atlas.build();
+        scene.resolve(atlas);
+        // decoding is not what is measured
+        atlas.finish();
+        RenderContext renderContext;
+        glm::mat4 proj = glm::mat4(1.0f);
+
+        // a fixed level, laid out over two screens so that sprites scroll in
+        Random rng;
+        rng.seed(1);
+        std::vector<BenchSprite> sprites;
+        for (unsigned int i = 0; i<options.zappers; i++){
+            unsigned int style = rng.below(ENTITY_ZAPPER_STYLES);
+            BenchSprite sprite = { &scene.zapperShape[style], &scene.zapperTexture[style],
+                glm::vec3(rng.range(2.0f) + 1.0f, rng.range(0.6f), 0.0f), SPRITE_GLOW };
+            sprites.push_back(sprite);
+        }
+        for (unsigned int i = 0; i<options.coins; i++){
+            BenchSprite sprite = { &scene.coinShape, &scene.coinTexture,
+                glm::vec3(rng.range(2.0f) + 1.0f, rng.range(0.8f), 0.0f), SPRITE_PLAIN };
+            sprites.push_back(sprite);
+        }
+
+        // HUD lines as the game has them, a label and a number that changes
+        std::vector<int> hudFields;
+        for (unsigned int i = 0; i<options.hud; i++){
+            float x = -0.95f + 0.65f*(i/24);
+            float y = 0.9f - 0.08f*(i%24);
+            int label = scene.textBatch.addField(x, y, 0.001f, glm::vec3(1.0f, 1.0f, 1.0f), 7);
+            scene.textBatch.setText(label, "Score: ");
+            hudFields.push_back(scene.textBatch.addFieldAfter(label, 10));
+        }
+
+        double cpuSeconds = 0.0;
+        unsigned int drawCalls = 0, stateChanges = 0;
+        unsigned long hudGlyphs = 0;
+        std::chrono::steady_clock::time_point start;
+        for (unsigned int frame = 0; frame < options.warmup + options.frames; frame++){
+            if (frame == options.warmup){
+                glFinish();
+                start = std::chrono::steady_clock::now();
+            }
+            std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+            renderContext.beginFrame();
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            float scroll = 0.01f*frame;
+            glm::vec3 background(-wrap(scroll, 2.0f), 0.0f, 0.0f);
+            scene.spriteBatch.draw(scene.backgroundShape, scene.backgroundTexture, background, SPRITE_ALPHA_TEST);
+            scene.spriteBatch.draw(scene.backgroundShape, scene.backgroundTexture,
+                background + glm::vec3(2.0f, 0.0f, 0.0f), SPRITE_ALPHA_TEST);
+            scene.spriteBatch.draw(scene.pillarShape, scene.pillarTexture,
+                glm::vec3(1.2f - wrap(scroll, 2.4f), -0.5f, 0.0f), SPRITE_ALPHA_TEST);
+            scene.spriteBatch.draw(scene.playerShape, scene.playerTexture[frame/6 % 3],
+                glm::vec3(-0.8f, -0.75f, 0.0f), SPRITE_PLAIN);
+            for (unsigned int i = 0; i<sprites.size(); i++){
+                glm::vec3 position = sprites[i].position;
+                position.x = wrap(position.x - scroll + 1.2f, 3.0f) - 1.2f;
+                scene.spriteBatch.draw(*sprites[i].shape, *sprites[i].texture, position, sprites[i].variant);
+            }
+            scene.spriteBatch.flush(renderContext, scene.spriteShaders, proj);
+
+            for (unsigned int i = 0; i<hudFields.size(); i++)
+                scene.textBatch.setNumber(hudFields[i], frame*7 + i);
+            scene.textBatch.flush(renderContext, scene.textShader);
+            if (frame >= options.warmup)
+                hudGlyphs += scene.textBatch.fieldGlyphs;
+
+            if (frame >= options.warmup)
+                cpuSeconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - frameStart).count();
+            drawCalls = renderContext.drawCalls;
+            stateChanges = renderContext.stateChanges;
+            glFinish();
+        }
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        char json[1024];
+        snprintf(json, sizeof(json),
+            "{\"renderer\": %s, \"width\": %d, \"height\": %d, "
+            "\"zappers\": %u, \"coins\": %u, \"hud\": %u, \"frames\": %u, "
+            "\"fps\": %.2f, \"ms_per_frame\": %.4f, \"cpu_ms_per_frame\": %.4f, "
+            "\"hud_glyphs_per_frame\": %.2f, \"draw_calls\": %u, \"state_changes\": %u, "
+            "\"gl_error\": %u}\n",
+            jsonString((const char*)glGetString(GL_RENDERER)).c_str(),
+            options.width, options.height, options.zappers, options.coins, options.hud,
+            options.frames, options.frames/seconds, 1000.0*seconds/options.frames,
+            1000.0*cpuSeconds/options.frames, (double)hudGlyphs/options.frames, drawCalls, stateChanges, glGetError());
+        fputs(json, stdout);
+        if (options.outPath){
+            FILE* out = fopen(options.outPath, "w");
+            if (!out || fputs(json, out) < 0){
+                fprintf(stderr, "bench_render: cannot write %s\n", options.outPath);
+                return 1;
+            }
+            fclose(out);
+        }
+    }
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef _BINARY_IO_H_
+#define _BINARY_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// FNV-1a: start from FNV_OFFSET_BASIS, feed the bytes of every part in
+// turn. Used for file names and checksums, not for anything adversarial.
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+
+inline uint64_t hashBytes(uint64_t hash, const void* data, size_t size){
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i<size; i++){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// fields are written one by one so the layout doesn't depend on padding
+template <typename T>
+inline bool writeValue(FILE* file, const T& value){
+    return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+inline bool readValue(FILE* file, T& value){
+    return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+// A file written aside and renamed over path by commit(), so a crash
+// never leaves half a file; without a successful commit the partial file
+// is removed.
+class AtomicFile{
+    public:
+        FILE* file;     // NULL if it could not be created
+
+        explicit AtomicFile(const std::string& path)
+            : path(path), partial(path + ".tmp"){
+            this->file = fopen(this->partial.c_str(), "wb");
+        }
+
+        ~AtomicFile(){
+            if (this->file){
+                fclose(this->file);
+                remove(this->partial.c_str());
+            }
+        }
+
+        // written is whether every write succeeded; false if it did not
+        // or closing or renaming failed
+        bool commit(bool written){
+            bool closed = fclose(this->file) == 0;
+            this->file = NULL;
+            if (written && closed && rename(this->partial.c_str(), this->path.c_str()) == 0)
+                return true;
+            remove(this->partial.c_str());
+            return false;
+        }
+
+    private:
+        std::string path;
+        std::string partial;
+
+        AtomicFile(const AtomicFile&);
+        AtomicFile& operator=(const AtomicFile&);
+};
+
+#endif
@@ -0,0 +1,110 @@
+#include "broadphase.h"
+
+#include <algorithm>
+
+// orders entity indices by x, ties by index so the build is deterministic;
+// scrolling keeps the x order but not the tie break, see remove()
+struct ByX{
+    const EntityStore& entities;
+
+    ByX(const EntityStore& entities) : entities(entities){}
+
+    bool operator()(unsigned int a, unsigned int b) const{
+        if (this->entities.x[a] != this->entities.x[b])
+            return this->entities.x[a] < this->entities.x[b];
+        return a < b;
+    }
+};
+
+Broadphase::Broadphase(){
+    this->head = 0;
+    this->count = 0;
+}
+
+unsigned int& Broadphase::at(unsigned int k){
+    return this->ring[(this->head + k) % this->ring.size()];
+}
+
+unsigned int Broadphase::at(unsigned int k) const{
+    return this->ring[(this->head + k) % this->ring.size()];
+}
+
+unsigned int Broadphase::size() const{
+    return this->count;
+}
+
+void Broadphase::build(const EntityStore& entities){
+    this->ring = entities.live;
+    std::sort(this->ring.begin(), this->ring.end(), ByX(entities));
+    this->head = 0;
+    this->count = entities.size();
+}
+
+void Broadphase::popBehind(const EntityStore& entities, float limit, std::vector<unsigned int>& out){
+    while (this->count > 0 && entities.x[this->at(0)] <= limit){
+        out.push_back(this->at(0));
+        this->head = (this->head + 1) % this->ring.size();
+        this->count--;
+    }
+}
+
+void Broadphase::insert(const EntityStore& entities, unsigned int i){
+    if (this->count == this->ring.size()){
+        // unrolled so the free slots follow the back
+        std::rotate(this->ring.begin(), this->ring.begin() + this->head, this->ring.end());
+        this->ring.resize(std::max<size_t>(16, this->ring.size()*2));
+        this->head = 0;
+    }
+
+    // spawns land at the far end, so this walks back a slot or two
+    ByX before(entities);
+    unsigned int k = this->count++;
+    while (k > 0 && before(i, this->at(k - 1))){
+        this->at(k) = this->at(k - 1);
+        k--;
+    }
+    this->at(k) = i;
+}
+
+void Broadphase::remove(const EntityStore& entities, unsigned int i){
+    // scrolling rounds x values that were apart onto each other, after
+    // which the index tie break no longer matches the order; so find the
+    // first entity at i's x and look for i among all of those
+    float x = entities.x[i];
+    unsigned int low = 0, high = this->count;
+    while (low < high){
+        unsigned int middle = (low + high)/2;
+        if (entities.x[this->at(middle)] < x)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    while (low < this->count && this->at(low) != i && entities.x[this->at(low)] == x)
+        low++;
+    if (low == this->count || this->at(low) != i)
+        return;
+
+    this->count--;
+    for (unsigned int k = low; k<this->count; k++)
+        this->at(k) = this->at(k + 1);
+}
+
+void Broadphase::query(const EntityStore& entities, float minX, float maxX,
+        std::vector<unsigned int>& out) const{
+    // first entity with x >= minX
+    unsigned int low = 0, high = this->count;
+    while (low < high){
+        unsigned int middle = (low + high)/2;
+        if (entities.x[this->at(middle)] < minX)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    for (unsigned int k = low; k<this->count; k++){
+        unsigned int i = this->at(k);
+        if (entities.x[i] > maxX)
+            break;
+        out.push_back(i);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef _BROADPHASE_H_
+#define _BROADPHASE_H_
+
+#include "entityStore.h"
+
+#include <vector>
+
+// Entity indices sorted by x, kept in a ring. The world only scrolls, which
+// keeps the order; entities leave at the front and are spawned near the
+// back, so staying sorted costs a few moves per spawn. Queries binary
+// search the ring and only touch the entities inside the x range.
+class Broadphase{
+    public:
+        Broadphase();
+
+        // sorts every live entity of the store
+        void build(const EntityStore& entities);
+
+        // removes the front entities with x <= limit and appends them to out
+        void popBehind(const EntityStore& entities, float limit, std::vector<unsigned int>& out);
+        // adds an entity at its current x, growing the ring when full
+        void insert(const EntityStore& entities, unsigned int i);
+        // takes an entity out from anywhere in the order
+        void remove(const EntityStore& entities, unsigned int i);
+
+        // appends every entity with minX <= x <= maxX, in x order
+        void query(const EntityStore& entities, float minX, float maxX,
+                std::vector<unsigned int>& out) const;
+
+        unsigned int size() const;
+
+    private:
+        std::vector<unsigned int> ring;     // grows to the most entities on screen
+        unsigned int head;                  // slot of the entity with the smallest x
+        unsigned int count;
+
+        // k-th entity in x order
+        unsigned int& at(unsigned int k);
+        unsigned int at(unsigned int k) const;
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLLISION_SSE 1
+#endif
+
+// padding entries sit far away so they never hit
+static const float farAway = 1e6f;
+
+// Hit shapes relative to the entity position. The diagonal zapper used to
+// test |d1 + d2 - length| < 0.05 with d1, d2 the distances to its two ends,
+// that is the ellipse with those ends as foci; it is stored in quadratic
+// form so no distance has to be taken.
+struct EllipseShape{
+    float a, b, c;
+};
+
+static EllipseShape focalEllipse(float endX, float endY, float slack){
+    float focus2 = endX*endX + endY*endY;                   // squared focal distance
+    float major = sqrt(focus2) + 0.5f*slack;                // semi-axes
+    float minor2 = major*major - focus2;
+    float major2 = major*major;
+
+    // u = (d . end)/|end|, v = (d x end)/|end|, inside when u²/major² + v²/minor² < 1
+    EllipseShape shape;
+    shape.a = (endX*endX/major2 + endY*endY/minor2)/focus2;
+    shape.b = (endX*endY/major2 - endX*endY/minor2)/focus2;
+    shape.c = (endY*endY/major2 + endX*endX/minor2)/focus2;
+    return shape;
+}
+
+static EllipseShape axisEllipse(float width2, float height2){
+    EllipseShape shape = { 1.0f/width2, 0.0f, 1.0f/height2 };
+    return shape;
+}
+
+// half of the horizontal extent, the dx where a*dx² + 2b*dx*dy + c*dy² = 1
+// touches a vertical line
+static float halfWidth(const EllipseShape& shape){
+    return sqrt(shape.c/(shape.a*shape.c - shape.b*shape.b));
+}
+
+static const EllipseShape diagonalZapper = focalEllipse(0.2f, 0.26f, 0.05f);
+static const EllipseShape coin = axisEllipse(0.03f, 0.1f);
+static const float horizontalHalfWidth = 0.245f;
+static const float verticalHalfWidth = 0.075f;
+
+CollisionKernel::CollisionKernel(){
+    this->boxCount = 0;
+    this->ellipseCount = 0;
+}
+
+float CollisionKernel::reach(){
+    static const float reach = std::max(std::max(horizontalHalfWidth, verticalHalfWidth),
+        std::max(halfWidth(diagonalZapper), halfWidth(coin)));
+    return reach;
+}
+
+void CollisionKernel::gather(const EntityStore& entities, const std::vector<unsigned int>& candidates){
+    BoxBucket& boxes = this->boxes;
+    EllipseBucket& ellipses = this->ellipses;
+    // enough for every entity in one bucket, rounded up to a group of four
+    unsigned int capacity = (candidates.size() + 3) & ~3u;
+    std::vector<float>* columns[9] = { &boxes.x, &boxes.y,
+        &boxes.halfWidth, &boxes.halfHeight, &ellipses.x, &ellipses.y,
+        &ellipses.a, &ellipses.b, &ellipses.c };
+    for (int c = 0; c<9; c++)
+        columns[c]->resize(capacity);
+    boxes.index.resize(capacity);
+    ellipses.index.resize(capacity);
+
+    unsigned int boxCount = 0, ellipseCount = 0;
+    for (unsigned int k = 0; k<candidates.size(); k++){
+        unsigned int i = candidates[k];
+        unsigned char type = entities.type[i];
+        if (type == ENTITY_ZAPPER_DIAGONAL || type == ENTITY_COIN){
+            const EllipseShape& shape = type == ENTITY_COIN ? coin : diagonalZapper;
+            unsigned int n = ellipseCount++;
+            ellipses.x[n] = entities.x[i];
+            ellipses.y[n] = entities.y[i];
+            ellipses.a[n] = shape.a;
+            ellipses.b[n] = shape.b;
+            ellipses.c[n] = shape.c;
+            ellipses.index[n] = i;
+        } else {
+            bool horizontal = type == ENTITY_ZAPPER_HORIZONTAL;
+            unsigned int n = boxCount++;
+            boxes.x[n] = entities.x[i];
+            boxes.y[n] = entities.y[i];
+            boxes.halfWidth[n] = horizontal ? horizontalHalfWidth : verticalHalfWidth;
+            boxes.halfHeight[n] = horizontal ? 0.11f : 0.40f;
+            boxes.index[n] = i;
+        }
+    }
+
+    // whole groups of four, so the kernels need no tail loop
+    for (; boxCount % 4; boxCount++){
+        boxes.x[boxCount] = farAway;
+        boxes.y[boxCount] = farAway;
+        boxes.halfWidth[boxCount] = 0.0f;
+        boxes.halfHeight[boxCount] = 0.0f;
+    }
+    for (; ellipseCount % 4; ellipseCount++){
+        ellipses.x[ellipseCount] = farAway;
+        ellipses.y[ellipseCount] = farAway;
+        ellipses.a[ellipseCount] = 1.0f;
+        ellipses.b[ellipseCount] = 0.0f;
+        ellipses.c[ellipseCount] = 1.0f;
+    }
+    this->boxCount = boxCount;
+    this->ellipseCount = ellipseCount;
+}
+
+#ifdef COLLISION_SSE
+
+static inline __m128 absolute(__m128 v){
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// lanes set in mask are hits, padding lanes never are
+static inline void appendHits(int mask, unsigned int base,
+        const std::vector<unsigned int>& index, std::vector<unsigned int>& hits){
+    while (mask){
+        int lane = 0;
+        while (!(mask & (1 << lane)))
+            lane++;
+        hits.push_back(index[base + lane]);
+        mask &= mask - 1;
+    }
+}
+
+void CollisionKernel::test(float px, float py, std::vector<unsigned int>& hits) const{
+    const __m128 playerX = _mm_set1_ps(px);
+    const __m128 playerY = _mm_set1_ps(py);
+
+    const BoxBucket& boxes = this->boxes;
+    for (unsigned int i = 0; i<this->boxCount; i += 4){
+        __m128 dx = absolute(_mm_sub_ps(playerX, _mm_loadu_ps(&boxes.x[i])));
+        __m128 dy = absolute(_mm_sub_ps(playerY, _mm_loadu_ps(&boxes.y[i])));
+        __m128 inside = _mm_and_ps(
+            _mm_cmplt_ps(dx, _mm_loadu_ps(&boxes.halfWidth[i])),
+            _mm_cmplt_ps(dy, _mm_loadu_ps(&boxes.halfHeight[i])));
+        appendHits(_mm_movemask_ps(inside), i, boxes.index, hits);
+    }
+
+    const EllipseBucket& ellipses = this->ellipses;
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (unsigned int i = 0; i<this->ellipseCount; i += 4){
+        __m128 dx = _mm_sub_ps(playerX, _mm_loadu_ps(&ellipses.x[i]));
+        __m128 dy = _mm_sub_ps(playerY, _mm_loadu_ps(&ellipses.y[i]));
+        __m128 dxy = _mm_mul_ps(dx, dy);
+        __m128 q = _mm_add_ps(
+            _mm_mul_ps(_mm_loadu_ps(&ellipses.a[i]), _mm_mul_ps(dx, dx)),
+            _mm_add_ps(
+                _mm_mul_ps(_mm_loadu_ps(&ellipses.b[i]), _mm_add_ps(dxy, dxy)),
+                _mm_mul_ps(_mm_loadu_ps(&ellipses.c[i]), _mm_mul_ps(dy, dy))));
+        appendHits(_mm_movemask_ps(_mm_cmplt_ps(q, one)), i, ellipses.index, hits);
+    }
+}
+
+#else
+
+void CollisionKernel::test(float px, float py, std::vector<unsigned int>& hits) const{
+    const BoxBucket& boxes = this->boxes;
+    for (unsigned int i = 0; i<this->boxCount; i++){
+        if (fabs(px - boxes.x[i]) < boxes.halfWidth[i]
+                && fabs(py - boxes.y[i]) < boxes.halfHeight[i])
+            hits.push_back(boxes.index[i]);
+    }
+
+    const EllipseBucket& ellipses = this->ellipses;
+    for (unsigned int i = 0; i<this->ellipseCount; i++){
+        float dx = px - ellipses.x[i];
+        float dy = py - ellipses.y[i];
+        float q = ellipses.a[i]*dx*dx + 2*ellipses.b[i]*dx*dy + ellipses.c[i]*dy*dy;
+        if (q < 1.0f)
+            hits.push_back(ellipses.index[i]);
+    }
+}
+
+#endif
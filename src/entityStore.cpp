@@ -0,0 +1,90 @@
+#include "entityStore.h"
+
+const unsigned int EntityStore::notLive;
+
+EntityStore::EntityStore(unsigned int capacity){
+    this->live.reserve(capacity);
+    this->addSlots(capacity > 0 ? capacity : 1);
+}
+
+void EntityStore::addSlots(unsigned int count){
+    unsigned int first = this->x.size();
+    unsigned int total = first + count;
+    this->x.resize(total, 0.0f);
+    this->y.resize(total, 0.0f);
+    this->previousX.resize(total, 0.0f);
+    this->previousY.resize(total, 0.0f);
+    this->velocity.resize(total, 0.0f);
+    this->type.resize(total, ENTITY_COIN);
+    this->livePosition.resize(total, notLive);
+    this->live.reserve(total);
+
+    // lowest slot on top, so spawns fill the store from the front
+    this->freeSlots.reserve(total);
+    for (unsigned int i = total; i>first; i--)
+        this->freeSlots.push_back(i - 1);
+}
+
+unsigned int EntityStore::spawn(EntityType type, float x, float y, float velocity){
+    if (this->freeSlots.empty())
+        this->addSlots(this->x.size());
+
+    unsigned int i = this->freeSlots.back();
+    this->freeSlots.pop_back();
+    this->x[i] = x;
+    this->y[i] = y;
+    this->previousX[i] = x;
+    this->previousY[i] = y;
+    this->velocity[i] = velocity;
+    this->type[i] = type;
+    this->livePosition[i] = this->live.size();
+    this->live.push_back(i);
+    return i;
+}
+
+void EntityStore::despawn(unsigned int i){
+    if (!this->isLive(i))
+        return;
+
+    // the last live entity takes the freed place in live
+    unsigned int position = this->livePosition[i];
+    unsigned int moved = this->live.back();
+    this->live[position] = moved;
+    this->livePosition[moved] = position;
+    this->live.pop_back();
+    this->livePosition[i] = notLive;
+    this->freeSlots.push_back(i);
+}
+
+void EntityStore::beginStep(){
+    const unsigned int* live = this->live.data();
+    unsigned int count = this->size();
+    for (unsigned int k = 0; k<count; k++){
+        unsigned int i = live[k];
+        this->previousX[i] = this->x[i];
+        this->previousY[i] = this->y[i];
+    }
+}
+
+void EntityStore::scroll(float dx){
+    const unsigned int* live = this->live.data();
+    float* x = this->x.data();
+    unsigned int count = this->size();
+    for (unsigned int k = 0; k<count; k++)
+        x[live[k]] += dx;
+}
+
+void EntityStore::bounce(float dt, float limit){
+    const unsigned int* live = this->live.data();
+    float* y = this->y.data();
+    float* velocity = this->velocity.data();
+    unsigned int count = this->size();
+    for (unsigned int k = 0; k<count; k++){
+        unsigned int i = live[k];
+        y[i] += velocity[i]*dt;
+        if (y[i] >= limit && velocity[i] > 0)
+            velocity[i] = -velocity[i];
+        else if (y[i] <= -limit && velocity[i] < 0)
+            velocity[i] = -velocity[i];
+    }
+}
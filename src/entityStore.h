@@ -0,0 +1,80 @@
+#ifndef _ENTITY_STORE_H_
+#define _ENTITY_STORE_H_
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// what an entity is, zapper values match the zapper texture index
+enum EntityType{
+    ENTITY_ZAPPER_VERTICAL = 0,
+    ENTITY_ZAPPER_MOVING = 1,       // vertical, bouncing up and down
+    ENTITY_ZAPPER_HORIZONTAL = 2,
+    ENTITY_ZAPPER_DIAGONAL = 3,
+    ENTITY_COIN = 4
+};
+
+const int ENTITY_ZAPPER_STYLES = 4;
+
+inline bool isZapper(unsigned char type){
+    return type < ENTITY_ZAPPER_STYLES;
+}
+
+// Zappers and coins as parallel arrays, entity i is the i-th element of
+// each. Per step work runs as plain loops over the arrays it needs; there
+// are no per-entity matrices, the renderer only needs the interpolated
+// position of each entity.
+//
+// Slots are preallocated and handed out from a free list, so spawning does
+// not allocate until more entities are live than the store was built for.
+// live lists the spawned slots densely; loops walk it and never see a free
+// slot, a despawned entity costs nothing.
+class EntityStore{
+    public:
+        std::vector<float> x;           // position at the end of the step
+        std::vector<float> y;
+        std::vector<float> previousX;   // at the start of the step
+        std::vector<float> previousY;
+        std::vector<float> velocity;    // vertical, 0 for static entities
+        std::vector<unsigned char> type;    // EntityType
+        std::vector<unsigned int> live;     // spawned slots, in no particular order
+
+        explicit EntityStore(unsigned int capacity = 256);
+
+        // live entities
+        unsigned int size() const{
+            return this->live.size();
+        }
+
+        bool isLive(unsigned int i) const{
+            return this->livePosition[i] != notLive;
+        }
+
+        // returns the slot of the new entity
+        unsigned int spawn(EntityType type, float x, float y, float velocity);
+        // frees the slot, the index may be reused by the next spawn
+        void despawn(unsigned int i);
+
+        void beginStep();
+        // scrolls everything horizontally by dx
+        void scroll(float dx);
+        // moves entities with a velocity, bouncing between -limit and limit
+        void bounce(float dt, float limit);
+
+        glm::vec3 interpolated(unsigned int i, float alpha) const{
+            return glm::vec3(this->previousX[i] + (this->x[i] - this->previousX[i])*alpha,
+                this->previousY[i] + (this->y[i] - this->previousY[i])*alpha,
+                0.0f);
+        }
+
+    private:
+        static const unsigned int notLive = ~0u;
+
+        std::vector<unsigned int> freeSlots;    // popped from the back
+        std::vector<unsigned int> livePosition; // index into live, or notLive
+
+        // appends free slots; past the initial capacity the store doubles
+        void addSlots(unsigned int count);
+};
+
+#endif
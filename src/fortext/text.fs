@@ -1,12 +1,16 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 TextColor;
 out vec4 color;
 
+// glyphs are signed distance fields, 0.5 on the outline (see SdfFont)
 uniform sampler2D text;
-uniform vec3 textColor;
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
-}  
\ No newline at end of file
+    float distance = texture(text, TexCoords).a;
+    // about one screen pixel of antialiasing at any text size
+    float width = 0.5 * fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(TextColor, alpha);
+}  
@@ -0,0 +1,276 @@
+#include "glyphCache.h"
+
+static const int cellsPerRow = GLYPH_PAGE_SIZE/GLYPH_CELL_SIZE;
+static const int cellsPerPage = cellsPerRow*cellsPerRow;
+// newer/older of a cell that is not in the recency list
+static const int unlinked = -2;
+
+GlyphCache::GlyphCache(const SdfFont& baked, const char* fontPath, ResourceManager& resources)
+    : baked(baked), fontPath(fontPath), resources(resources){
+    this->rasterized = 0;
+    this->evicted = 0;
+    this->fontTried = false;
+    for (int c = 0; c<GLYPH_COUNT; c++)
+        this->ascii[c] = -1;
+    this->pagesAllocated = 0;
+    this->newest = -1;
+    this->oldest = -1;
+    this->frame = 0;
+    Character missing = { 0, glm::vec4(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+    this->missing = missing;
+}
+
+GlyphCache::~GlyphCache(){
+    if (!this->pages.empty())
+        glDeleteTextures(this->pages.size(), &this->pages[0]);
+    for (unsigned int p = 0; p<this->pages.size(); p++)
+        this->resources.untrack(RESOURCE_TEXTURE, GLYPH_PAGE_SIZE*GLYPH_PAGE_SIZE);
+}
+
+bool GlyphCache::available(){
+    return this->baked.loaded || this->fontOpen();
+}
+
+bool GlyphCache::fontOpen(){
+    if (!this->fontTried){
+        this->fontTried = true;
+        this->rasterizer.open(this->fontPath.c_str());
+    }
+    return this->rasterizer.isOpen();
+}
+
+unsigned int GlyphCache::pageCount() const{
+    return this->pages.size();
+}
+
+int& GlyphCache::slot(uint32_t codepoint){
+    if (codepoint < (uint32_t)GLYPH_COUNT)
+        return this->ascii[codepoint];
+    std::unordered_map<uint32_t, int>::iterator found = this->others.find(codepoint);
+    if (found == this->others.end())
+        found = this->others.insert(std::make_pair(codepoint, -1)).first;
+    return found->second;
+}
+
+const Character& GlyphCache::get(uint32_t codepoint){
+    // references into the map survive the inserts and erases of load()
+    int& index = this->slot(codepoint);
+    if (index < 0)
+        index = this->load(codepoint);
+    if (index < 0){
+        // no cell free this frame, tried again on the next
+        if (codepoint >= (uint32_t)GLYPH_COUNT)
+            this->others.erase(codepoint);
+        return this->missing;
+    }
+
+    const Entry& entry = this->entries[index];
+    if (entry.cell >= 0)
+        this->touch(entry.cell);
+    return entry.glyph;
+}
+
+int GlyphCache::load(uint32_t codepoint){
+    // with every cell drawn this frame there is nowhere to put it, skip the
+    // rasterizing until a later frame
+    bool full = this->freeCells.empty() && this->pages.size() == GLYPH_MAX_PAGES
+        && this->cellFrame[this->oldest] == this->frame;
+    if (full)
+        return -1;
+
+    SdfGlyph rendered = SdfGlyph();
+    const SdfGlyph* field = &rendered;
+    if (codepoint < (uint32_t)GLYPH_COUNT && this->baked.loaded){
+        field = &this->baked.glyphs[codepoint];
+    } else if (this->fontOpen() && this->rasterizer.render(codepoint, rendered)){
+        this->rasterized++;
+    }
+    // a glyph that fails or outgrows a cell keeps its advance but draws
+    // nothing, and is not tried again
+    if (rendered.width > GLYPH_CELL_SIZE - 2 || rendered.height > GLYPH_CELL_SIZE - 2){
+        rendered.width = rendered.height = 0;
+        rendered.field.clear();
+    }
+
+    Character glyph = { 0, glm::vec4(0.0f), glm::ivec2(field->width, field->height),
+        glm::ivec2(field->bearingX, field->bearingY), field->advance };
+    int cell = -1;
+    if (field->width > 0 && field->height > 0){
+        cell = this->takeCell();
+        if (cell < 0)
+            return -1;
+
+        // one texel in from the cell's corner, the margin stays empty
+        int inPage = cell % cellsPerPage;
+        int x = (inPage % cellsPerRow)*GLYPH_CELL_SIZE + 1;
+        int y = (inPage / cellsPerRow)*GLYPH_CELL_SIZE + 1;
+        glyph.TextureID = this->pages[cell / cellsPerPage];
+        glyph.UVRect = glm::vec4(x, y, field->width, field->height)/(float)GLYPH_PAGE_SIZE;
+
+        PendingUpload upload = { cell, field->width, field->height, this->staging.size() };
+        this->pending.push_back(upload);
+        this->staging.insert(this->staging.end(), field->field.begin(), field->field.end());
+    }
+
+    int index;
+    if (this->freeEntries.empty()){
+        index = this->entries.size();
+        this->entries.push_back(Entry());
+    } else {
+        index = this->freeEntries.back();
+        this->freeEntries.pop_back();
+    }
+    Entry& entry = this->entries[index];
+    entry.codepoint = codepoint;
+    entry.glyph = glyph;
+    entry.cell = cell;
+    if (cell >= 0)
+        this->cellEntry[cell] = index;
+    return index;
+}
+
+int GlyphCache::takeCell(){
+    if (this->freeCells.empty() && this->pages.size() < GLYPH_MAX_PAGES)
+        this->addPage();
+    if (!this->freeCells.empty()){
+        int cell = this->freeCells.back();
+        this->freeCells.pop_back();
+        return cell;
+    }
+
+    // every page is full: the least recently drawn glyph makes room,
+    // unless the whole cache is in use this frame
+    int cell = this->oldest;
+    if (cell < 0 || this->cellFrame[cell] == this->frame)
+        return -1;
+    const Entry& owner = this->entries[this->cellEntry[cell]];
+    if (owner.codepoint < (uint32_t)GLYPH_COUNT)
+        this->ascii[owner.codepoint] = -1;
+    else
+        this->others.erase(owner.codepoint);
+    this->freeEntries.push_back(this->cellEntry[cell]);
+    this->cellEntry[cell] = -1;
+    this->unlink(cell);
+    this->evicted++;
+    return cell;
+}
+
+void GlyphCache::addPage(){
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    this->pages.push_back(texture);
+    // one byte a texel, storage is made at the next upload
+    this->resources.track(RESOURCE_TEXTURE, GLYPH_PAGE_SIZE*GLYPH_PAGE_SIZE);
+
+    int first = this->cellEntry.size();
+    int count = first + cellsPerPage;
+    this->cellEntry.resize(count, -1);
+    this->cellFrame.resize(count, 0);
+    this->newer.resize(count, unlinked);
+    this->older.resize(count, unlinked);
+    // lowest cell on top, pages fill from their first row
+    for (int cell = count - 1; cell >= first; cell--)
+        this->freeCells.push_back(cell);
+}
+
+void GlyphCache::unlink(int cell){
+    if (this->newer[cell] == unlinked)
+        return;
+    if (this->newer[cell] >= 0)
+        this->older[this->newer[cell]] = this->older[cell];
+    else
+        this->newest = this->older[cell];
+    if (this->older[cell] >= 0)
+        this->newer[this->older[cell]] = this->newer[cell];
+    else
+        this->oldest = this->newer[cell];
+    this->newer[cell] = unlinked;
+    this->older[cell] = unlinked;
+}
+
+void GlyphCache::touch(int cell){
+    this->cellFrame[cell] = this->frame;
+    if (cell == this->newest)
+        return;
+    this->unlink(cell);
+    this->newer[cell] = -1;
+    this->older[cell] = this->newest;
+    if (this->newest >= 0)
+        this->newer[this->newest] = cell;
+    this->newest = cell;
+    if (this->oldest < 0)
+        this->oldest = cell;
+}
+
+void GlyphCache::upload(RenderContext& context){
+    // pages get storage once, cleared so the cell margins sample as outside
+    if (this->pagesAllocated < this->pages.size()){
+        std::vector<unsigned char> empty(GLYPH_PAGE_SIZE*GLYPH_PAGE_SIZE, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (; this->pagesAllocated < this->pages.size(); this->pagesAllocated++){
+            context.bindTexture(this->pages[this->pagesAllocated]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 0,
+                GL_RED, GL_UNSIGNED_BYTE, &empty[0]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            // read as white with the field in alpha, like the RGBA atlas
+            GLint swizzle[4] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    if (this->pending.empty())
+        return;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int i = 0; i<this->pending.size(); i++){
+        const PendingUpload& upload = this->pending[i];
+        int inPage = upload.cell % cellsPerPage;
+        context.bindTexture(this->pages[upload.cell / cellsPerPage]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0,
+            (inPage % cellsPerRow)*GLYPH_CELL_SIZE + 1, (inPage / cellsPerRow)*GLYPH_CELL_SIZE + 1,
+            upload.width, upload.height, GL_RED, GL_UNSIGNED_BYTE, &this->staging[upload.offset]);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    this->pending.clear();
+    this->staging.clear();
+}
+
+void GlyphCache::endFrame(){
+    this->frame++;
+}
+
+uint32_t GlyphCache::decodeUtf8(std::string::const_iterator& c, std::string::const_iterator end){
+    unsigned char lead = *c++;
+    if (lead < 0x80)
+        return lead;
+
+    int length;
+    uint32_t codepoint;
+    if ((lead & 0xe0) == 0xc0){
+        length = 1;
+        codepoint = lead & 0x1f;
+    } else if ((lead & 0xf0) == 0xe0){
+        length = 2;
+        codepoint = lead & 0x0f;
+    } else if ((lead & 0xf8) == 0xf0){
+        length = 3;
+        codepoint = lead & 0x07;
+    } else {
+        return 0xfffd;
+    }
+
+    for (int i = 0; i<length; i++){
+        if (c == end || (*c & 0xc0) != 0x80)
+            return 0xfffd;
+        codepoint = (codepoint << 6) | (*c++ & 0x3f);
+    }
+    // overlong forms, surrogates and values past Unicode
+    static const uint32_t smallest[4] = { 0, 0x80, 0x800, 0x10000 };
+    if (codepoint < smallest[length] || codepoint > 0x10ffff
+            || (codepoint >= 0xd800 && codepoint <= 0xdfff))
+        return 0xfffd;
+    return codepoint;
+}
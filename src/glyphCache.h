@@ -0,0 +1,116 @@
+#ifndef _GLYPH_CACHE_H_
+#define _GLYPH_CACHE_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "module.h"
+#include "sdfFont.h"
+#include "resources.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// square cells on a page, each holds one glyph field with a texel of margin
+const int GLYPH_PAGE_SIZE = 512;
+const int GLYPH_CELL_SIZE = 64;
+// pages allocated at most, GLYPH_PAGE_SIZE^2 bytes each
+const unsigned int GLYPH_MAX_PAGES = 4;
+
+// a glyph ready to draw, metrics in pixels of its distance field
+struct Character {
+    unsigned int TextureID; // page holding the glyph, 0 if it has no pixels
+    glm::vec4    UVRect;    // Glyph rectangle inside the page
+    glm::ivec2   Size;      // Size of glyph
+    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
+    unsigned int Advance;   // Horizontal offset to advance to next glyph
+};
+
+// Glyphs loaded on first use. A codepoint is looked up in a flat table for
+// ASCII and a hash map otherwise; a miss copies the baked field (ASCII) or
+// rasterizes it with FreeType, and takes a cell on a single channel page.
+// Pages are only added up to GLYPH_MAX_PAGES, after that the least
+// recently drawn glyph gives up its cell, never one drawn this frame.
+// Fields reach GL at flush time through the RenderContext, so binding
+// tracking stays right; pages are counted in the ResourceManager.
+class GlyphCache{
+    public:
+        unsigned int rasterized;    // glyphs made with FreeType
+        unsigned int evicted;       // cells taken from an older glyph
+
+        // baked may hold no glyphs, fontPath is opened on the first glyph
+        // it lacks
+        GlyphCache(const SdfFont& baked, const char* fontPath, ResourceManager& resources);
+        ~GlyphCache();
+
+        // true if glyphs can be had from the baked set or the font
+        bool available();
+
+        // the glyph of a codepoint, made on a miss; valid until the next get()
+        const Character& get(uint32_t codepoint);
+
+        // sends the fields made since the last call to their pages
+        void upload(RenderContext& context);
+        // glyphs drawn before this may be evicted again
+        void endFrame();
+
+        unsigned int pageCount() const;
+
+        // next codepoint of UTF-8 text, malformed bytes give U+FFFD
+        static uint32_t decodeUtf8(std::string::const_iterator& c, std::string::const_iterator end);
+
+    private:
+        struct Entry{
+            uint32_t codepoint;
+            Character glyph;
+            int cell;               // -1 for glyphs without pixels
+        };
+        struct PendingUpload{
+            int cell;
+            int width;
+            int height;
+            size_t offset;          // into staging
+        };
+
+        const SdfFont& baked;
+        std::string fontPath;
+        SdfRasterizer rasterizer;
+        bool fontTried;
+
+        std::vector<Entry> entries;
+        std::vector<int> freeEntries;
+        int ascii[GLYPH_COUNT];                     // entry of each ASCII code, or -1
+        std::unordered_map<uint32_t, int> others;   // the rest
+
+        std::vector<unsigned int> pages;            // textures, storage made at upload
+        unsigned int pagesAllocated;                // pages with storage
+        // per cell: owning entry, frame of its last use and the recency list
+        std::vector<int> cellEntry;
+        std::vector<unsigned int> cellFrame;
+        std::vector<int> newer;
+        std::vector<int> older;
+        int newest;
+        int oldest;
+        std::vector<int> freeCells;
+        unsigned int frame;
+
+        std::vector<unsigned char> staging;
+        std::vector<PendingUpload> pending;
+        Character missing;
+        ResourceManager& resources;
+
+        bool fontOpen();
+        int& slot(uint32_t codepoint);
+        int load(uint32_t codepoint);
+        int takeCell();
+        void addPage();
+        void unlink(int cell);
+        void touch(int cell);
+
+        GlyphCache(const GlyphCache&);
+        GlyphCache& operator=(const GlyphCache&);
+};
+
+#endif
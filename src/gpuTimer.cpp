@@ -0,0 +1,58 @@
+#include "gpuTimer.h"
+
+GpuTimer::GpuTimer(Profiler& profiler) : profiler(profiler){
+    this->used[0] = this->used[1] = 0;
+    this->frame = 0;
+    this->depth = 0;
+}
+
+GpuTimer::~GpuTimer(){
+    for (unsigned int set = 0; set<2; set++){
+        for (unsigned int i = 0; i<this->queries[set].size(); i++)
+            glDeleteQueries(1, &this->queries[set][i].id);
+    }
+}
+
+void GpuTimer::beginFrame(){
+    this->frame++;
+    this->collect(this->frame & 1);
+}
+
+void GpuTimer::begin(const char* name){
+    if (this->depth++ > 0)
+        return;
+
+    std::vector<Query>& set = this->queries[this->frame & 1];
+    unsigned int& used = this->used[this->frame & 1];
+    if (used == set.size()){
+        Query query;
+        glGenQueries(1, &query.id);
+        set.push_back(query);
+    }
+    Query& query = set[used++];
+    query.name = name;
+    query.issued = this->profiler.now();
+    glBeginQuery(GL_TIME_ELAPSED, query.id);
+}
+
+void GpuTimer::end(){
+    // the query belongs to the outermost scope
+    if (this->depth == 0 || --this->depth > 0)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+void GpuTimer::collect(unsigned int set){
+    for (unsigned int i = 0; i<this->used[set]; i++){
+        const Query& query = this->queries[set][i];
+        int available = 0;
+        glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &nanoseconds);
+        this->profiler.record(query.name, query.issued, nanoseconds*1e-9, PROFILE_GPU);
+    }
+    this->used[set] = 0;
+}
@@ -0,0 +1,65 @@
+#ifndef _GPU_TIMER_H_
+#define _GPU_TIMER_H_
+
+#include <glad/glad.h>
+
+#include "profiler.h"
+
+#include <vector>
+
+// GL_TIME_ELAPSED queries feeding a Profiler. Queries are double buffered:
+// a frame's results are read two frames later, when the GPU is done with
+// them, and dropped rather than waited for if they are still not ready.
+// Only one query can be active at a time, so a scope opened inside another
+// is counted as part of the outer one. The GPU row of the trace places each
+// scope at the CPU time it was issued.
+class GpuTimer{
+    public:
+        explicit GpuTimer(Profiler& profiler);
+        ~GpuTimer();
+
+        // call once per frame before any scope
+        void beginFrame();
+
+        // name must be a string literal
+        void begin(const char* name);
+        void end();
+
+    private:
+        struct Query{
+            unsigned int id;
+            const char* name;
+            double issued;      // CPU time of begin()
+        };
+
+        Profiler& profiler;
+        std::vector<Query> queries[2];
+        unsigned int used[2];
+        unsigned int frame;
+        unsigned int depth;     // scopes open, only the outermost has a query
+
+        void collect(unsigned int set);
+
+        GpuTimer(const GpuTimer&);
+        GpuTimer& operator=(const GpuTimer&);
+};
+
+// times the GL commands issued in the enclosing block
+class GpuScope{
+    public:
+        GpuScope(GpuTimer& timer, const char* name) : timer(timer){
+            timer.begin(name);
+        }
+
+        ~GpuScope(){
+            this->timer.end();
+        }
+
+    private:
+        GpuTimer& timer;
+
+        GpuScope(const GpuScope&);
+        GpuScope& operator=(const GpuScope&);
+};
+
+#endif
@@ -0,0 +1,200 @@
+// Runs the game simulation without a window or GL context, driven by a
+// virtual clock and a scripted input, for balance testing and CI.
+//
+//   app_headless [--runs N] [--seed S] [--script 45:0,25:1] [--max-seconds T]
+//                [--record FILE] [--endless] [--verbose]
+//   app_headless --replay FILE
+//
+// The script is a list of <steps>:<fly> pairs that repeats until the run ends.
+// --record saves the first run; --replay re-runs a recording (also one made
+// by the windowed game) and fails if the end state differs from the recorded.
+// --endless plays past the third level, runs then end by crash or timeout.
+
+#include "simulation.h"
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+struct ScriptEntry{
+    unsigned long steps;
+    bool fly;
+};
+
+// parses "45:0,25:1" into entries, returns false on malformed input
+static bool parseScript(const char* text, std::vector<ScriptEntry>& script){
+    script.clear();
+    while (*text){
+        char* end;
+        unsigned long steps = strtoul(text, &end, 10);
+        if (end == text || *end != ':' || steps == 0)
+            return false;
+        text = end + 1;
+        if (*text != '0' && *text != '1')
+            return false;
+        ScriptEntry entry = { steps, *text == '1' };
+        script.push_back(entry);
+        text++;
+        if (*text == ',')
+            text++;
+        else if (*text)
+            return false;
+    }
+    return !script.empty();
+}
+
+// fly state for a given step, the script loops
+static bool scriptedFly(const std::vector<ScriptEntry>& script,
+        unsigned long scriptLength, unsigned long step){
+    step %= scriptLength;
+    for (unsigned int i = 0; i<script.size(); i++){
+        if (step < script[i].steps)
+            return script[i].fly;
+        step -= script[i].steps;
+    }
+    return false;
+}
+
+// plays a recording back and compares the end state, returns the exit code
+static int verifyReplay(const char* path){
+    Replay replay;
+    if (!replay.load(path))
+        return 1;
+
+    World world("headless", replay.seed, replay.endless);
+    world.game.verbose = false;
+
+    SimInput input;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (replay.next(input))
+        world.step(input);
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    uint64_t checksum = world.checksum();
+    printf("replay %s: seed %llu, %llu steps (%.2fs simulated, %.3fs wall)\n", path,
+        (unsigned long long)replay.seed, (unsigned long long)replay.steps, world.time, elapsed);
+    printf("level %u score %u, checksum %016llx recorded %016llx\n",
+        world.game.level, world.game.score,
+        (unsigned long long)checksum, (unsigned long long)replay.checksum);
+
+    if (replay.step != SIM_STEP){
+        printf("DIVERGED: recorded with a step of %gs, this build uses %gs\n",
+            replay.step, SIM_STEP);
+        return 1;
+    }
+    if (checksum != replay.checksum){
+        printf("DIVERGED\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
+
+int main(int argc, char** argv){
+    unsigned long runs = 1000;
+    unsigned long seed = time(NULL);
+    double maxSeconds = 300.0;
+    bool verbose = false;
+    bool endless = false;
+    const char* recordPath = NULL;
+    std::vector<ScriptEntry> script;
+    parseScript("45:0,25:1", script);
+
+    for (int i = 1; i<argc; i++){
+        if (!strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            seed = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--max-seconds") && i + 1 < argc)
+            maxSeconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--script") && i + 1 < argc){
+            if (!parseScript(argv[++i], script)){
+                fprintf(stderr, "invalid script '%s', expected e.g. 45:0,25:1\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--record") && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+            return verifyReplay(argv[++i]);
+        else if (!strcmp(argv[i], "--endless"))
+            endless = true;
+        else if (!strcmp(argv[i], "--verbose"))
+            verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [--runs N] [--seed S] [--script 45:0,25:1] [--max-seconds T]"
+                " [--record FILE] [--endless] [--verbose]\n"
+                "       %s --replay FILE\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    unsigned long scriptLength = 0;
+    for (unsigned int i = 0; i<script.size(); i++)
+        scriptLength += script[i].steps;
+    unsigned long maxSteps = maxSeconds/SIM_STEP;
+
+    unsigned long won = 0, crashed = 0, timedOut = 0;
+    unsigned long totalScore = 0, totalSteps = 0;
+    unsigned int levelReached[4] = { 0, 0, 0, 0 };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned long run = 0; run<runs; run++){
+        World world("headless", seed + run, endless);
+        world.game.verbose = false;
+
+        Replay replay(seed + run, endless);
+        if (recordPath && run == 0)
+            world.recorder = &replay;
+
+        SimInput input;
+        while (!world.isOver() && world.steps < maxSteps){
+            input.fly = scriptedFly(script, scriptLength, world.steps);
+            world.step(input);
+        }
+
+        if (world.recorder){
+            replay.finish(world);
+            replay.save(recordPath);
+        }
+
+        const char* outcome;
+        if (world.game.isGameWon){
+            outcome = "won";
+            won++;
+        } else if (world.game.zapperCollision){
+            outcome = "crashed";
+            crashed++;
+        } else {
+            outcome = "timeout";
+            timedOut++;
+        }
+        totalScore += world.game.score;
+        totalSteps += world.steps;
+        levelReached[std::min(world.game.level, 3u)]++;
+
+        if (verbose)
+            printf("run %lu seed %lu: %s level %u score %u time %.2fs\n",
+                run, seed + run, outcome, world.game.level, world.game.score, world.time);
+    }
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("runs %lu (seed %lu): won %lu, crashed %lu, timeout %lu\n",
+        runs, seed, won, crashed, timedOut);
+    printf("levels reached: 0:%u 1:%u 2:%u 3%s:%u\n",
+        levelReached[0], levelReached[1], levelReached[2], endless ? "+" : "", levelReached[3]);
+    if (runs > 0)
+        printf("mean score %.2f, mean survival %.2fs\n",
+            totalScore / static_cast<double>(runs), totalSteps*SIM_STEP / runs);
+    printf("%.3fs wall, %.0f runs/s, %.2e steps/s\n", elapsed,
+        runs/elapsed, totalSteps/elapsed);
+    return 0;
+}
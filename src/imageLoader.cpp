@@ -0,0 +1,115 @@
+#include "imageLoader.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+ImageLoader::ImageLoader(unsigned int threads){
+    if (threads == 0)
+        threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 4u);
+
+    this->outstanding = 0;
+    this->stopping = false;
+    for (unsigned int i = 0; i<threads; i++)
+        this->workers.push_back(std::thread(&ImageLoader::work, this));
+}
+
+ImageLoader::~ImageLoader(){
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+        this->jobs.clear();
+    }
+    this->wake.notify_all();
+    for (unsigned int i = 0; i<this->workers.size(); i++)
+        this->workers[i].join();
+}
+
+void ImageLoader::load(int tag, const std::string& path, int padding){
+    Job job = { tag, path, padding };
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->jobs.push_back(job);
+        this->outstanding++;
+    }
+    this->wake.notify_one();
+}
+
+bool ImageLoader::poll(LoadedImage& image){
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->done.empty())
+        return false;
+
+    image.tag = this->done.front().tag;
+    image.width = this->done.front().width;
+    image.height = this->done.front().height;
+    image.failed = this->done.front().failed;
+    image.pixels.swap(this->done.front().pixels);
+    this->done.pop_front();
+    this->outstanding--;
+    return true;
+}
+
+unsigned int ImageLoader::pending() const{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->outstanding;
+}
+
+void ImageLoader::work(){
+    while (true){
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (this->jobs.empty() && !this->stopping)
+                this->wake.wait(lock);
+            if (this->stopping)
+                return;
+            job = this->jobs.front();
+            this->jobs.pop_front();
+        }
+
+        LoadedImage image;
+        image.tag = job.tag;
+        image.width = image.height = 0;
+        image.failed = false;
+
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(job.path.c_str(), &width, &height, &nrChannels, 4);
+        if (data){
+            extrudeImage(data, width, height, job.padding, image.pixels);
+            image.width = width + 2*job.padding;
+            image.height = height + 2*job.padding;
+        } else {
+            std::cout << "Failed to load texture " << job.path << std::endl;
+            image.failed = true;
+        }
+        stbi_image_free(data);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->done.push_back(LoadedImage());
+        this->done.back().tag = image.tag;
+        this->done.back().width = image.width;
+        this->done.back().height = image.height;
+        this->done.back().failed = image.failed;
+        this->done.back().pixels.swap(image.pixels);
+    }
+}
+
+void extrudeImage(const unsigned char* pixels, int width, int height, int pad,
+        std::vector<unsigned char>& out){
+    int outWidth = width + 2*pad;
+    int outHeight = height + 2*pad;
+    out.resize(outWidth*outHeight*4);
+    for (int y = 0; y<outHeight; y++){
+        int srcY = std::min(std::max(y - pad, 0), height - 1);
+        unsigned char* row = &out[y*outWidth*4];
+        const unsigned char* src = &pixels[srcY*width*4];
+        for (int x = 0; x<pad; x++){
+            memcpy(row + x*4, src, 4);
+            memcpy(row + (pad + width + x)*4, src + (width - 1)*4, 4);
+        }
+        memcpy(row + pad*4, src, width*4);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef _IMAGE_LOADER_H_
+#define _IMAGE_LOADER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// a decoded image, RGBA with its edges extruded by padding texels
+struct LoadedImage{
+    int tag;                // passed through from load()
+    int width;              // including the padding
+    int height;
+    std::vector<unsigned char> pixels;
+    bool failed;
+};
+
+// Decodes PNGs on a pool of worker threads. The main thread queues paths
+// and later collects whatever has finished, so no GL work happens here.
+class ImageLoader{
+    public:
+        // 0 threads picks one per core, at most four
+        ImageLoader(unsigned int threads = 0);
+        ~ImageLoader();
+
+        void load(int tag, const std::string& path, int padding);
+
+        // moves one finished image out, returns false if none is ready
+        bool poll(LoadedImage& image);
+        // images queued but not yet collected with poll()
+        unsigned int pending() const;
+
+    private:
+        struct Job{
+            int tag;
+            std::string path;
+            int padding;
+        };
+
+        std::vector<std::thread> workers;
+        std::deque<Job> jobs;
+        std::deque<LoadedImage> done;
+        unsigned int outstanding;
+        bool stopping;
+        mutable std::mutex mutex;
+        std::condition_variable wake;
+
+        void work();
+};
+
+// copies a w*h RGBA image into the centre of a (w + 2*pad)*(h + 2*pad)
+// one, repeating the edge texels outwards so filtering and lower mip
+// levels do not pick up whatever lies next to it in an atlas
+void extrudeImage(const unsigned char* pixels, int width, int height, int pad,
+        std::vector<unsigned char>& out);
+
+#endif
@@ -0,0 +1,127 @@
+#include "levelGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+
+// zapper spacing at density 1, the distance of the original layout
+static const float slotLength = 0.8f;
+// max horizontal offset of a coin, relative to the zapper spacing
+static const float coinJitter = 0.25f;
+
+static const EntityType staticZappers[] = {
+    ENTITY_ZAPPER_VERTICAL, ENTITY_ZAPPER_HORIZONTAL, ENTITY_ZAPPER_DIAGONAL
+};
+
+static float grow(float value, float extra, float step, float limit){
+    return std::min(value + extra*step, std::max(value, limit));
+}
+
+LevelDifficulty DifficultyCurve::at(unsigned int level) const{
+    if (level < this->levels.size())
+        return this->levels[level];
+
+    LevelDifficulty difficulty = this->levels.back();
+    float extra = level - (this->levels.size() - 1);
+    difficulty.speed = grow(difficulty.speed, extra, this->step.speed, this->limit.speed);
+    difficulty.density = grow(difficulty.density, extra, this->step.density, this->limit.density);
+    difficulty.movingChance = grow(difficulty.movingChance, extra,
+        this->step.movingChance, this->limit.movingChance);
+    difficulty.coinChance = grow(difficulty.coinChance, extra,
+        this->step.coinChance, this->limit.coinChance);
+    difficulty.coinMovingChance = grow(difficulty.coinMovingChance, extra,
+        this->step.coinMovingChance, this->limit.coinMovingChance);
+    return difficulty;
+}
+
+DifficultyCurve DifficultyCurve::classic(){
+    // speed, density, moving zapper, coin, moving coin
+    static const LevelDifficulty levels[] = {
+        { 0.45f, 1.0f, 0.25f, 1.0f, 0.3f },
+        { 0.50f, 1.0f, 0.25f, 1.0f, 0.3f },
+        { 0.70f, 1.0f, 0.25f, 1.0f, 0.3f },
+        { 0.80f, 1.0f, 0.25f, 1.0f, 0.3f }
+    };
+    DifficultyCurve curve;
+    curve.levels.assign(levels, levels + sizeof(levels)/sizeof(levels[0]));
+    LevelDifficulty step = { 0.05f, 0.15f, 0.05f, 0.0f, 0.05f };
+    LevelDifficulty limit = { 1.2f, 3.0f, 0.6f, 1.0f, 0.6f };
+    curve.step = step;
+    curve.limit = limit;
+    return curve;
+}
+
+// ----------------------------------------------------------------------------
+
+LevelGenerator::LevelGenerator(uint64_t seed, const DifficultyCurve& curve, float levelLength):
+    rng(seed), difficulty(curve), stopping(false){
+    this->nextIndex = 0;
+    this->chunksPerLevel = std::max(1, (int)(levelLength/LEVEL_CHUNK_LENGTH + 0.5f));
+}
+
+LevelGenerator::~LevelGenerator(){
+    this->stopping.store(true, std::memory_order_relaxed);
+    if (this->worker.joinable())
+        this->worker.join();
+}
+
+void LevelGenerator::start(){
+    if (!this->worker.joinable())
+        this->worker = std::thread(&LevelGenerator::run, this);
+}
+
+void LevelGenerator::next(LevelChunk& chunk){
+    if (!this->worker.joinable()){
+        this->generate(chunk);
+        return;
+    }
+    // a chunk lasts seconds and the queue holds several, this only spins
+    // after a long stall of the worker
+    while (!this->queue.pop(chunk))
+        std::this_thread::yield();
+}
+
+const DifficultyCurve& LevelGenerator::curve() const{
+    return this->difficulty;
+}
+
+void LevelGenerator::run(){
+    LevelChunk chunk;
+    this->generate(chunk);
+    while (!this->stopping.load(std::memory_order_relaxed)){
+        if (this->queue.push(chunk))
+            this->generate(chunk);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void LevelGenerator::generate(LevelChunk& chunk){
+    chunk.index = this->nextIndex++;
+    chunk.level = 1 + chunk.index/this->chunksPerLevel;
+    chunk.count = 0;
+    LevelDifficulty difficulty = this->difficulty.at(chunk.level);
+
+    // zappers on an even grid with a coin halfway between each pair
+    int slots = (int)(LEVEL_CHUNK_LENGTH/slotLength*difficulty.density + 0.5f);
+    slots = std::min(std::max(slots, 1), (int)LEVEL_CHUNK_CAPACITY/2);
+    float spacing = LEVEL_CHUNK_LENGTH/slots;
+
+    for (int j = 0; j<slots; j++){
+        if (this->rng.uniform() < difficulty.coinChance){
+            ChunkEntry& coin = chunk.entries[chunk.count++];
+            coin.type = ENTITY_COIN;
+            coin.x = (j + 0.25f)*spacing + this->rng.range(coinJitter*spacing);
+            coin.y = this->rng.range(1.0f);
+            coin.moving = this->rng.uniform() < difficulty.coinMovingChance;
+        }
+
+        ChunkEntry& zapper = chunk.entries[chunk.count++];
+        if (this->rng.uniform() < difficulty.movingChance)
+            zapper.type = ENTITY_ZAPPER_MOVING;
+        else
+            zapper.type = staticZappers[this->rng.below(3)];
+        zapper.x = (j + 0.75f)*spacing;
+        zapper.y = this->rng.range(1.0f);
+        zapper.moving = zapper.type == ENTITY_ZAPPER_MOVING;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef _LEVEL_GENERATOR_H_
+#define _LEVEL_GENERATOR_H_
+
+#include "entityStore.h"
+#include "random.h"
+#include "spscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// world units covered by one chunk, levels are a whole number of chunks
+const float LEVEL_CHUNK_LENGTH = 2.4f;
+// most entities a chunk can hold, bounds the density
+const unsigned int LEVEL_CHUNK_CAPACITY = 64;
+// chunks generated ahead of the one in use
+const unsigned int LEVEL_QUEUE_SIZE = 8;
+
+// how a level plays
+struct LevelDifficulty{
+    float speed;            // scroll speed, world units per second
+    float density;          // zappers per 0.8 units, 1 is the original layout
+    float movingChance;     // of a zapper bouncing up and down
+    float coinChance;       // of a coin between two zappers
+    float coinMovingChance;
+};
+
+// Difficulty by level. Level 0 is the run-up to the first pillar; levels
+// past the table keep growing by step each, up to limit, for endless runs.
+struct DifficultyCurve{
+    std::vector<LevelDifficulty> levels;
+    LevelDifficulty step;
+    LevelDifficulty limit;
+
+    LevelDifficulty at(unsigned int level) const;
+
+    // the three levels of the original game, faster each time
+    static DifficultyCurve classic();
+};
+
+// one entity of a chunk
+struct ChunkEntry{
+    EntityType type;
+    float x;                // from the chunk start, in [0, LEVEL_CHUNK_LENGTH)
+    float y;                // in [-1, 1], scaled to the play area by the world
+    bool moving;
+};
+
+// a stretch of level, entries in x order
+struct LevelChunk{
+    unsigned int index;
+    unsigned int level;
+    unsigned int count;
+    ChunkEntry entries[LEVEL_CHUNK_CAPACITY];
+};
+
+// Lays out the level in chunks, chunk k starting k chunk lengths after the
+// first pillar. A chunk depends only on the seed and on the chunks before
+// it, so the layout is the same whether it is generated inline or on the
+// worker thread, and replays stay exact.
+//
+// Until start() chunks are generated when asked for. After it a worker
+// keeps the queue filled, the caller only pops; it waits for the worker
+// only if it fell a whole queue behind.
+class LevelGenerator{
+    public:
+        LevelGenerator(uint64_t seed, const DifficultyCurve& curve, float levelLength);
+        ~LevelGenerator();
+
+        // moves generation to a worker thread
+        void start();
+
+        // the next chunk in order
+        void next(LevelChunk& chunk);
+
+        const DifficultyCurve& curve() const;
+
+    private:
+        // owned by the worker once started
+        Random rng;
+        unsigned int nextIndex;
+
+        DifficultyCurve difficulty;
+        unsigned int chunksPerLevel;
+
+        SpscQueue<LevelChunk, LEVEL_QUEUE_SIZE> queue;
+        std::thread worker;
+        std::atomic<bool> stopping;
+
+        void generate(LevelChunk& chunk);
+        void run();
+
+        LevelGenerator(const LevelGenerator&);
+        LevelGenerator& operator=(const LevelGenerator&);
+};
+
+#endif
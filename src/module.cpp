@@ -1,73 +1,80 @@
 #include "module.h"
 
-float genRand(float x){
-    float rand01 = rand() / static_cast<float>(RAND_MAX);
-    rand01 = 2*rand01 - 1;
-    return rand01* x;
+// binding state nobody has set through the context yet
+static const unsigned int UNKNOWN_BINDING = ~0u;
+
+RenderContext::RenderContext(){
+    this->invalidate();
+    this->beginFrame();
+}
+
+void RenderContext::beginFrame(){
+    this->drawCalls = 0;
+    this->stateChanges = 0;
+}
+
+void RenderContext::invalidate(){
+    this->program = UNKNOWN_BINDING;
+    this->VAO = UNKNOWN_BINDING;
+    this->arrayBuffer = UNKNOWN_BINDING;
+    this->texture = UNKNOWN_BINDING;
+    this->blend = UNKNOWN_BINDING;
+}
+
+void RenderContext::useProgram(const Shader& shader){
+    if (this->program == shader.ID)
+        return;
+    glUseProgram(shader.ID);
+    this->program = shader.ID;
+    this->stateChanges++;
 }
 
-void genVertex(unsigned int* VBOAddr, unsigned int* VAOAddr, 
-        float vertices[], unsigned long verticesSize){
-    glGenVertexArrays(1, VAOAddr);
-    glGenBuffers(1, VBOAddr);
-    glBindVertexArray(*VAOAddr);
-    glBindBuffer(GL_ARRAY_BUFFER, *VBOAddr);
-    glBufferData(GL_ARRAY_BUFFER, verticesSize, vertices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+void RenderContext::bindVertexArray(unsigned int VAO){
+    if (this->VAO == VAO)
+        return;
+    glBindVertexArray(VAO);
+    this->VAO = VAO;
+    this->stateChanges++;
 }
 
-void enableMatrices(Shader shader, glm::mat4 model, glm::mat4 proj){
-    int modelLoc = glGetUniformLocation(shader.ID, "model");
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	int projLoc = glGetUniformLocation(shader.ID, "proj");
-	glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(proj));
+void RenderContext::bindArrayBuffer(unsigned int buffer){
+    if (this->arrayBuffer == buffer)
+        return;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    this->arrayBuffer = buffer;
+    this->stateChanges++;
 }
 
-void renderShape(unsigned int VAO, unsigned int texture, 
-        Shader shader, int numVertices,
-        glm::mat4 model, glm::mat4 proj){
-        // bind Texture
-        glBindTexture(GL_TEXTURE_2D, texture);
-        // enabling matrices
-    	enableMatrices(shader, model, proj);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);   
+void RenderContext::bindTexture(unsigned int texture){
+    if (this->texture == texture)
+        return;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    this->texture = texture;
+    this->stateChanges++;
 }
 
-void genTexture(unsigned int* textureAddr, const char* imagePath){
-    glGenTextures(1, textureAddr);
-    glBindTexture(GL_TEXTURE_2D, *textureAddr); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
-    unsigned char *data = stbi_load(imagePath, &width, &height, &nrChannels, 0);
-    // std::cout<<imagePath<<" "<<nrChannels<<std::endl;
-    if (data)
-    {
-        if (nrChannels == 3)
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        else
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
+void RenderContext::setBlend(bool enabled){
+    if (this->blend == (unsigned int)enabled)
+        return;
+    if (enabled)
+        glEnable(GL_BLEND);
     else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_BLEND);
+    this->blend = enabled;
+    this->stateChanges++;
+}
+
+void RenderContext::drawArrays(GLenum mode, int first, int count){
+    glDrawArrays(mode, first, count);
+    this->drawCalls++;
 }
 
+void RenderContext::drawArraysInstanced(GLenum mode, int first, int count, int instances){
+    glDrawArraysInstanced(mode, first, count, instances);
+    this->drawCalls++;
+}
+
+void RenderContext::multiDrawArrays(GLenum mode, const int* first, const int* count, int ranges){
+    glMultiDrawArrays(mode, first, count, ranges);
+    this->drawCalls++;
+}
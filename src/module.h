@@ -15,18 +15,36 @@
 #include <map>
 #include <string>
 
-float genRand(float x);
-
-void genVertex(unsigned int* VBOAddr, unsigned int* VAOAddr, 
-        float vertices[], unsigned long verticesSize);
-
-void enableMatrices(Shader shader, glm::mat4 model, 
-        glm::mat4 proj);
-
-void renderShape(unsigned int VAO, unsigned int texture, 
-        Shader shader, int numVertices,
-        glm::mat4 model, glm::mat4 proj);
-
-void genTexture(unsigned int* textureAddr, const char* imagePath);
+// Shadows the GL bindings the render loop touches so that binding an
+// object that is already bound, or unbinding between draws, costs nothing.
+// Anything that binds behind its back must call invalidate().
+class RenderContext{
+    public:
+        unsigned int drawCalls;     // since beginFrame()
+        unsigned int stateChanges;  // binds actually sent to GL since beginFrame()
+
+        RenderContext();
+
+        void beginFrame();
+        void invalidate();
+
+        void useProgram(const Shader& shader);
+        void bindVertexArray(unsigned int VAO);
+        void bindArrayBuffer(unsigned int buffer);
+        void bindTexture(unsigned int texture);
+        void setBlend(bool enabled);
+
+        void drawArrays(GLenum mode, int first, int count);
+        void drawArraysInstanced(GLenum mode, int first, int count, int instances);
+        // one call for several ranges of the bound vertex array
+        void multiDrawArrays(GLenum mode, const int* first, const int* count, int ranges);
+
+    private:
+        unsigned int program;
+        unsigned int VAO;
+        unsigned int arrayBuffer;
+        unsigned int texture;
+        unsigned int blend;
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,230 @@
+// Bakes everything the game loads into one asset pack: the texture atlas
+// pages with full mip chains, the ASCII glyph distance fields and the shader
+// sources.
+//
+//   asset_packer [--root DIR] [--out FILE] [--embed FILE.cpp]
+//
+// --root is the source directory the asset names are relative to
+// (default ../src/). --embed also writes a source file that links the
+// pack into an executable, see EMBED_ASSET_PACK in CMakeLists.txt.
+
+#include "assetPack.h"
+#include "atlasLayout.h"
+#include "imageLoader.h"
+#include "sdfFont.h"
+
+#include <stb_image.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Blob{
+    PackEntry entry;
+    std::vector<unsigned char> data;
+};
+
+static PackEntry makeEntry(const std::string& name, PackKind kind){
+    PackEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+    entry.kind = kind;
+    if (name.size() >= sizeof(entry.name))
+        std::cout << "WARNING: asset name too long, truncated: " << name << std::endl;
+    return entry;
+}
+
+static bool writeEmbedSource(const char* sourcePath, const char* packPath){
+    std::ofstream out(sourcePath);
+    if (!out)
+        return false;
+#ifdef __APPLE__
+    const char* prefix = "_";
+    const char* section = ".const_data";
+#else
+    const char* prefix = "";
+    const char* section = ".section .rodata";
+#endif
+    out << "// generated by asset_packer, links " << packPath << " into the executable\n"
+        << "#include <cstddef>\n\n"
+        << "__asm__(\n"
+        << "    \"" << section << "\\n\"\n"
+        << "    \".balign " << PACK_ALIGNMENT << "\\n\"\n"
+        << "    \".globl " << prefix << "embeddedAssetPack\\n\"\n"
+        << "    \"" << prefix << "embeddedAssetPack:\\n\"\n"
+        << "    \".incbin \\\"" << packPath << "\\\"\\n\"\n"
+        << "    \"" << prefix << "embeddedAssetPackEnd:\\n\"\n"
+        << "    \".text\\n\");\n\n"
+        << "extern \"C\" const unsigned char embeddedAssetPack[];\n"
+        << "extern \"C\" const unsigned char embeddedAssetPackEnd[];\n"
+        << "extern \"C\" const size_t embeddedAssetPackSize = embeddedAssetPackEnd - embeddedAssetPack;\n";
+    return out.good();
+}
+
+int main(int argc, char** argv){
+    std::string root = "../src/";
+    const char* outPath = "assets.pack";
+    const char* embedPath = NULL;
+    for (int i = 1; i<argc; i++){
+        if (!strcmp(argv[i], "--root") && i + 1 < argc)
+            root = std::string(argv[++i]) + "/";
+        else if (!strcmp(argv[i], "--out") && i + 1 < argc)
+            outPath = argv[++i];
+        else if (!strcmp(argv[i], "--embed") && i + 1 < argc)
+            embedPath = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--root DIR] [--out FILE] [--embed FILE.cpp]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // same orientation the game loads images with
+    stbi_set_flip_vertically_on_load(true);
+
+    std::vector<std::vector<unsigned char> > images;
+    std::vector<glm::ivec2> sizes;
+    std::vector<std::string> names;
+    SdfFont font;
+    if (!font.generate(GLYPH_FONT))
+        return 1;
+
+    for (unsigned int i = 0; i<sizeof(PACKED_IMAGES)/sizeof(PACKED_IMAGES[0]); i++){
+        std::string path = root + PACKED_IMAGES[i];
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
+        if (!data){
+            std::cout << "Failed to load texture " << path << std::endl;
+            return 1;
+        }
+        images.push_back(std::vector<unsigned char>(data, data + width*height*4));
+        sizes.push_back(glm::ivec2(width, height));
+        names.push_back(PACKED_IMAGES[i]);
+        stbi_image_free(data);
+    }
+
+    // lay the atlas out like the runtime would and compose its pages
+    std::vector<AtlasPlacement> placements;
+    std::vector<glm::ivec2> pageExtent = layoutAtlas(sizes, ATLAS_PAGE_SIZE,
+        ATLAS_PADDING, placements);
+    std::vector<std::vector<unsigned char> > pages(pageExtent.size());
+    for (unsigned int p = 0; p<pages.size(); p++)
+        pages[p].assign(pageExtent[p].x*pageExtent[p].y*4, 0);
+
+    std::vector<PackRegion> regions(images.size());
+    std::vector<unsigned char> padded;
+    for (unsigned int i = 0; i<images.size(); i++){
+        const AtlasPlacement& placement = placements[i];
+        PackRegion& region = regions[i];
+        memset(&region, 0, sizeof(region));
+        strncpy(region.name, names[i].c_str(), sizeof(region.name) - 1);
+        region.page = placement.page;
+        region.x = placement.x;
+        region.y = placement.y;
+        region.width = sizes[i].x;
+        region.height = sizes[i].y;
+        if (sizes[i].x == 0 || sizes[i].y == 0)
+            continue;
+
+        extrudeImage(&images[i][0], sizes[i].x, sizes[i].y, ATLAS_PADDING, padded);
+        int pageWidth = pageExtent[placement.page].x;
+        int rowBytes = (sizes[i].x + 2*ATLAS_PADDING)*4;
+        for (int y = 0; y<sizes[i].y + 2*ATLAS_PADDING; y++){
+            int dstX = placement.x - ATLAS_PADDING;
+            int dstY = placement.y - ATLAS_PADDING + y;
+            memcpy(&pages[placement.page][(dstY*pageWidth + dstX)*4],
+                &padded[y*rowBytes], rowBytes);
+        }
+    }
+
+    std::vector<Blob> blobs;
+    for (unsigned int p = 0; p<pages.size(); p++){
+        Blob blob;
+        blob.entry = makeEntry("atlas/page" + std::to_string(p), PACK_TEXTURE);
+        blob.entry.width = pageExtent[p].x;
+        blob.entry.height = pageExtent[p].y;
+
+        // the full chain, so the runtime needs no glGenerateMipmap
+        std::vector<unsigned char> level = pages[p], next;
+        int width = pageExtent[p].x, height = pageExtent[p].y;
+        while (true){
+            blob.data.insert(blob.data.end(), level.begin(), level.end());
+            blob.entry.levels++;
+            if (width == 1 && height == 1)
+                break;
+            downsampleImage(&level[0], width, height, next, width, height);
+            level.swap(next);
+        }
+        blobs.push_back(blob);
+    }
+
+    Blob regionBlob;
+    regionBlob.entry = makeEntry("atlas/regions", PACK_DATA);
+    regionBlob.data.assign(reinterpret_cast<unsigned char*>(&regions[0]),
+        reinterpret_cast<unsigned char*>(&regions[0] + regions.size()));
+    blobs.push_back(regionBlob);
+
+    Blob fontBlob;
+    fontBlob.entry = makeEntry("font/sdf", PACK_DATA);
+    font.write(fontBlob.data);
+    blobs.push_back(fontBlob);
+
+    for (unsigned int i = 0; i<sizeof(PACKED_SHADERS)/sizeof(PACKED_SHADERS[0]); i++){
+        std::string path = root + PACKED_SHADERS[i];
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file){
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return 1;
+        }
+        std::stringstream source;
+        source << file.rdbuf();
+        std::string text = source.str();
+
+        Blob blob;
+        blob.entry = makeEntry(PACKED_SHADERS[i], PACK_TEXT);
+        blob.data.assign(text.begin(), text.end());
+        blobs.push_back(blob);
+    }
+
+    // header, table, then every blob at an aligned offset
+    PackHeader header = { PACK_MAGIC, PACK_VERSION, (uint32_t)blobs.size(), 0 };
+    uint64_t offset = sizeof(header) + blobs.size()*sizeof(PackEntry);
+    for (unsigned int i = 0; i<blobs.size(); i++){
+        offset = (offset + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+        blobs[i].entry.offset = offset;
+        blobs[i].entry.size = blobs[i].data.size();
+        offset += blobs[i].data.size();
+    }
+
+    FILE* out = fopen(outPath, "wb");
+    if (!out){
+        std::cout << "ERROR: cannot write " << outPath << std::endl;
+        return 1;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (unsigned int i = 0; ok && i<blobs.size(); i++)
+        ok = fwrite(&blobs[i].entry, sizeof(PackEntry), 1, out) == 1;
+    static const unsigned char zeros[PACK_ALIGNMENT] = { 0 };
+    for (unsigned int i = 0; ok && i<blobs.size(); i++){
+        long position = ftell(out);
+        ok = fwrite(zeros, 1, blobs[i].entry.offset - position, out) == blobs[i].entry.offset - position;
+        if (ok && !blobs[i].data.empty())
+            ok = fwrite(&blobs[i].data[0], blobs[i].data.size(), 1, out) == 1;
+    }
+    if (fclose(out) != 0 || !ok){
+        std::cout << "ERROR: failed writing " << outPath << std::endl;
+        return 1;
+    }
+    printf("%s: %u entries, %u atlas pages, %.1f MB\n", outPath,
+        (unsigned int)blobs.size(), (unsigned int)pages.size(), offset/(1024.0*1024.0));
+
+    if (embedPath && !writeEmbedSource(embedPath, outPath)){
+        std::cout << "ERROR: cannot write " << embedPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "profiler.h"
+
+#include <cstdio>
+#include <iostream>
+
+Profiler::Profiler(unsigned int capacity){
+    this->events.resize(capacity > 0 ? capacity : 1);
+    this->head = 0;
+    this->count = 0;
+    this->depth = 0;
+    this->origin = std::chrono::steady_clock::now();
+}
+
+double Profiler::now() const{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - this->origin).count();
+}
+
+void Profiler::begin(const char* name){
+    if (this->depth < maxDepth){
+        this->stackName[this->depth] = name;
+        this->stackStart[this->depth] = this->now();
+    }
+    this->depth++;
+}
+
+void Profiler::end(){
+    if (this->depth == 0)
+        return;
+    this->depth--;
+    if (this->depth < maxDepth){
+        double start = this->stackStart[this->depth];
+        this->record(this->stackName[this->depth], start, this->now() - start, PROFILE_CPU);
+    }
+}
+
+void Profiler::record(const char* name, double start, double duration, int track){
+    ProfileEvent& event = this->events[this->head];
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    event.track = track;
+
+    this->head = (this->head + 1) % this->events.size();
+    if (this->count < this->events.size())
+        this->count++;
+}
+
+unsigned int Profiler::size() const{
+    return this->count;
+}
+
+bool Profiler::writeChromeTrace(const char* path) const{
+    FILE* file = fopen(path, "w");
+    if (!file){
+        std::cout << "ERROR::PROFILER::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU\"}},\n", PROFILE_CPU);
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", PROFILE_GPU);
+
+    // oldest first
+    unsigned int first = (this->head + this->events.size() - this->count) % this->events.size();
+    for (unsigned int i = 0; i<this->count; i++){
+        const ProfileEvent& event = this->events[(first + i) % this->events.size()];
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            event.name, event.track, event.start*1e6, event.duration*1e6);
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    if (ok)
+        std::cout << "wrote " << this->count << " profile events to " << path << std::endl;
+    return ok;
+}
@@ -0,0 +1,74 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <chrono>
+#include <vector>
+
+// trace rows, as thread ids in the exported trace
+enum ProfileTrack{
+    PROFILE_CPU = 1,
+    PROFILE_GPU = 2
+};
+
+// one finished scope; name must be a string literal
+struct ProfileEvent{
+    const char* name;
+    double start;       // seconds since the profiler was created
+    double duration;
+    int track;
+};
+
+// Keeps the most recent scopes in a fixed ring buffer and exports them as
+// Chrome trace JSON (chrome://tracing, ui.perfetto.dev). Recording a scope
+// is two clock reads and a store, no allocation. GL-free; GPU times are
+// fed in by GpuTimer.
+class Profiler{
+    public:
+        explicit Profiler(unsigned int capacity = 1 << 16);
+
+        double now() const;
+
+        // nested CPU scopes, prefer ProfileScope
+        void begin(const char* name);
+        void end();
+
+        void record(const char* name, double start, double duration, int track);
+
+        // events held, at most capacity
+        unsigned int size() const;
+        bool writeChromeTrace(const char* path) const;
+
+    private:
+        static const int maxDepth = 32;
+
+        std::vector<ProfileEvent> events;
+        unsigned int head;      // next slot to write
+        unsigned int count;
+        std::chrono::steady_clock::time_point origin;
+        const char* stackName[maxDepth];
+        double stackStart[maxDepth];
+        int depth;
+};
+
+// times the enclosing block, does nothing without a profiler
+class ProfileScope{
+    public:
+        ProfileScope(Profiler* profiler, const char* name){
+            this->profiler = profiler;
+            if (profiler)
+                profiler->begin(name);
+        }
+
+        ~ProfileScope(){
+            if (this->profiler)
+                this->profiler->end();
+        }
+
+    private:
+        Profiler* profiler;
+
+        ProfileScope(const ProfileScope&);
+        ProfileScope& operator=(const ProfileScope&);
+};
+
+#endif
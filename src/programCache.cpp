@@ -0,0 +1,134 @@
+#include "programCache.h"
+#include "binaryIO.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <sys/stat.h>
+
+static const char cacheMagic[4] = { 'J', 'P', 'S', 'B' };
+static const uint32_t cacheVersion = 1;
+
+static std::string glString(GLenum name){
+    const char* value = reinterpret_cast<const char*>(glGetString(name));
+    return value ? value : "";
+}
+
+// ----------------------------------------------------------------------------
+
+ProgramCache::ProgramCache(const std::string& directory){
+    this->loaded = 0;
+    this->stored = 0;
+    this->directory = directory;
+    this->driver = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+
+    int formats = 0;
+    if (GLAD_GL_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    this->supported = formats > 0;
+    if (this->supported)
+        mkdir(directory.c_str(), 0755);
+}
+
+bool ProgramCache::enabled() const{
+    return this->supported;
+}
+
+uint64_t ProgramCache::key(const std::string& vertex, const std::string& fragment) const{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    // the terminators keep "ab"+"c" and "a"+"bc" apart
+    hash = hashBytes(hash, vertex.c_str(), vertex.size() + 1);
+    hash = hashBytes(hash, fragment.c_str(), fragment.size() + 1);
+    return hashBytes(hash, this->driver.c_str(), this->driver.size() + 1);
+}
+
+std::string ProgramCache::path(uint64_t key) const{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)key);
+    return this->directory + name;
+}
+
+unsigned int ProgramCache::load(const std::string& vertex, const std::string& fragment){
+    if (!this->supported)
+        return 0;
+
+    uint64_t key = this->key(vertex, fragment);
+    FILE* file = fopen(this->path(key).c_str(), "rb");
+    if (!file)
+        return 0;
+
+    char magic[4];
+    uint32_t version = 0, format = 0, length = 0;
+    uint64_t storedKey = 0;
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+        && !memcmp(magic, cacheMagic, sizeof(magic))
+        && readValue(file, version) && version == cacheVersion
+        && readValue(file, storedKey) && storedKey == key
+        && readValue(file, format)
+        && readValue(file, length) && length > 0;
+    // a damaged file must not ask for more than it holds
+    if (ok){
+        long header = ftell(file);
+        ok = fseek(file, 0, SEEK_END) == 0 && ftell(file) - header >= (long)length
+            && fseek(file, header, SEEK_SET) == 0;
+    }
+    std::vector<char> binary(ok ? length : 0);
+    ok = ok && fread(&binary[0], length, 1, file) == 1;
+    fclose(file);
+    if (!ok)
+        return 0;
+
+    // a driver may still refuse a binary it wrote, e.g. after an update
+    // that kept its version string
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, format, &binary[0], length);
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success){
+        glDeleteProgram(program);
+        return 0;
+    }
+    this->loaded++;
+    return program;
+}
+
+void ProgramCache::prepare(unsigned int program) const{
+    if (this->supported)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::store(unsigned int program, const std::string& vertex, const std::string& fragment){
+    if (!this->supported)
+        return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, &binary[0]);
+    if (length <= 0)
+        return;
+
+    uint64_t key = this->key(vertex, fragment);
+    std::string path = this->path(key);
+    AtomicFile out(path);
+    if (!out.file){
+        std::cout << "ERROR::PROGRAM_CACHE::CANNOT_WRITE " << path << std::endl;
+        return;
+    }
+    bool ok = fwrite(cacheMagic, sizeof(cacheMagic), 1, out.file) == 1
+        && writeValue(out.file, cacheVersion)
+        && writeValue(out.file, key)
+        && writeValue(out.file, static_cast<uint32_t>(format))
+        && writeValue(out.file, static_cast<uint32_t>(length))
+        && fwrite(&binary[0], length, 1, out.file) == 1;
+    if (!out.commit(ok)){
+        std::cout << "ERROR::PROGRAM_CACHE::WRITE_FAILED " << path << std::endl;
+        return;
+    }
+    this->stored++;
+}
@@ -0,0 +1,40 @@
+#ifndef _PROGRAM_CACHE_H_
+#define _PROGRAM_CACHE_H_
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+
+// Linked program binaries on disk (ARB_get_program_binary), so that later
+// launches skip GLSL compilation. A program is stored under the hash of its
+// sources and the GL vendor, renderer and version strings: editing a shader
+// or updating the driver simply misses the cache. Does nothing when the
+// driver offers no binary format.
+class ProgramCache{
+    public:
+        unsigned int loaded;    // programs restored from disk
+        unsigned int stored;    // programs compiled and written
+
+        // directory is created if missing; needs a current context
+        explicit ProgramCache(const std::string& directory);
+
+        bool enabled() const;
+
+        // a linked program for these sources, 0 on a miss or if the
+        // driver rejects the stored binary
+        unsigned int load(const std::string& vertex, const std::string& fragment);
+        // call before linking so the driver keeps the binary around
+        void prepare(unsigned int program) const;
+        void store(unsigned int program, const std::string& vertex, const std::string& fragment);
+
+    private:
+        std::string directory;
+        std::string driver;     // vendor, renderer and version
+        bool supported;
+
+        uint64_t key(const std::string& vertex, const std::string& fragment) const;
+        std::string path(uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <cstdint>
+
+// PCG32 (O'Neill, pcg-random.org): small, fast and, unlike rand(), the
+// same sequence on every platform for a given seed.
+class Random{
+    public:
+        Random(uint64_t seed = 0){
+            this->seed(seed);
+        }
+
+        void seed(uint64_t seed){
+            this->state = 0;
+            this->increment = (seed << 1u) | 1u;
+            this->next();
+            this->state += seed;
+            this->next();
+        }
+
+        uint32_t next(){
+            uint64_t old = this->state;
+            this->state = old*6364136223846793005ULL + this->increment;
+            uint32_t xorshifted = ((old >> 18u) ^ old) >> 27u;
+            uint32_t rot = old >> 59u;
+            return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+        }
+
+        // uniform in [0, 1)
+        float uniform(){
+            return (this->next() >> 8) * (1.0f/16777216.0f);
+        }
+
+        // uniform in [-x, x)
+        float range(float x){
+            return (2*this->uniform() - 1)*x;
+        }
+
+        // uniform integer in [0, n)
+        int below(int n){
+            return this->next() % n;
+        }
+
+    private:
+        uint64_t state;
+        uint64_t increment;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "replay.h"
+#include "binaryIO.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static const char replayMagic[4] = { 'J', 'P', 'R', 'P' };
+static const uint32_t replayVersion = 3;
+
+Replay::Replay(uint64_t seed, bool endless){
+    this->seed = seed;
+    this->endless = endless;
+    this->steps = 0;
+    this->checksum = 0;
+    this->step = SIM_STEP;
+    this->rewind();
+}
+
+void Replay::record(const SimInput& input){
+    if (this->runs.empty() || this->runs.back().fly != input.fly
+            || this->runs.back().steps == UINT32_MAX){
+        ReplayRun run = { 0, input.fly };
+        this->runs.push_back(run);
+    }
+    this->runs.back().steps++;
+    this->steps++;
+}
+
+void Replay::finish(const World& world){
+    this->checksum = world.checksum();
+}
+
+bool Replay::save(const char* path) const{
+    FILE* file = fopen(path, "wb");
+    if (!file){
+        std::cout << "ERROR::REPLAY::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    bool ok = fwrite(replayMagic, sizeof(replayMagic), 1, file) == 1
+        && writeValue(file, replayVersion)
+        && writeValue(file, this->seed)
+        && writeValue(file, static_cast<uint8_t>(this->endless))
+        && writeValue(file, this->step)
+        && writeValue(file, this->steps)
+        && writeValue(file, this->checksum)
+        && writeValue(file, static_cast<uint32_t>(this->runs.size()));
+    for (unsigned int i = 0; ok && i<this->runs.size(); i++){
+        uint8_t fly = this->runs[i].fly;
+        ok = writeValue(file, this->runs[i].steps) && writeValue(file, fly);
+    }
+
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        std::cout << "ERROR::REPLAY::WRITE_FAILED " << path << std::endl;
+    return ok;
+}
+
+bool Replay::load(const char* path){
+    FILE* file = fopen(path, "rb");
+    if (!file){
+        std::cout << "ERROR::REPLAY::CANNOT_READ " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, runCount = 0;
+    uint8_t endless = 0;
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+        && !memcmp(magic, replayMagic, sizeof(magic))
+        && readValue(file, version) && version == replayVersion
+        && readValue(file, this->seed)
+        && readValue(file, endless)
+        && readValue(file, this->step)
+        && readValue(file, this->steps)
+        && readValue(file, this->checksum)
+        && readValue(file, runCount);
+
+    this->runs.clear();
+    uint64_t total = 0;
+    for (uint32_t i = 0; ok && i<runCount; i++){
+        ReplayRun run;
+        uint8_t fly;
+        ok = readValue(file, run.steps) && readValue(file, fly);
+        run.fly = fly != 0;
+        total += run.steps;
+        this->runs.push_back(run);
+    }
+    fclose(file);
+    this->endless = endless != 0;
+
+    if (ok && total != this->steps)
+        ok = false;
+    if (!ok){
+        std::cout << "ERROR::REPLAY::INVALID_FILE " << path << std::endl;
+        this->runs.clear();
+        this->steps = 0;
+    }
+    this->rewind();
+    return ok;
+}
+
+void Replay::rewind(){
+    this->cursorRun = 0;
+    this->cursorStep = 0;
+}
+
+bool Replay::next(SimInput& input){
+    while (this->cursorRun < this->runs.size()
+            && this->cursorStep >= this->runs[this->cursorRun].steps){
+        this->cursorRun++;
+        this->cursorStep = 0;
+    }
+    if (this->cursorRun >= this->runs.size())
+        return false;
+
+    input.fly = this->runs[this->cursorRun].fly;
+    this->cursorStep++;
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "simulation.h"
+
+#include <cstdint>
+#include <vector>
+
+// consecutive steps that share the same input
+struct ReplayRun{
+    uint32_t steps;
+    bool fly;
+};
+
+// A recorded run: the seed and mode the World was built with and the input
+// of every step. Frame times are not stored, the fixed step makes them
+// irrelevant, so playing the inputs back on a World with the same seed
+// reproduces the run exactly. The final checksum lets a playback detect
+// divergence.
+class Replay{
+    public:
+        uint64_t seed;
+        bool endless;           // World built in endless mode
+        uint64_t steps;
+        uint64_t checksum;      // World::checksum() after the last step
+        float step;             // SIM_STEP at record time
+        std::vector<ReplayRun> runs;
+
+        Replay(uint64_t seed = 0, bool endless = false);
+
+        // appends the input of one simulated step
+        void record(const SimInput& input);
+        // stores the end state once recording is over
+        void finish(const World& world);
+
+        bool save(const char* path) const;
+        bool load(const char* path);
+
+        // playback, returns false once every recorded step was consumed
+        void rewind();
+        bool next(SimInput& input);
+
+    private:
+        unsigned int cursorRun;
+        uint32_t cursorStep;
+};
+
+#endif
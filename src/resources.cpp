@@ -0,0 +1,42 @@
+#include "resources.h"
+
+ResourceManager::ResourceManager(){
+    for (int i = 0; i<RESOURCE_KINDS; i++){
+        this->counts[i].live = 0;
+        this->counts[i].bytes = 0;
+    }
+}
+
+ResourceManager::~ResourceManager(){
+    // owners must not outlive their manager
+    for (int i = 0; i<RESOURCE_KINDS; i++){
+        if (this->counts[i].live > 0){
+            std::cout << "ERROR::RESOURCES::GPU objects still alive at exit" << std::endl;
+            this->print(std::cout);
+            break;
+        }
+    }
+}
+
+void ResourceManager::track(ResourceKind kind, size_t bytes){
+    this->counts[kind].live++;
+    this->counts[kind].bytes += bytes;
+}
+
+void ResourceManager::untrack(ResourceKind kind, size_t bytes){
+    this->counts[kind].live--;
+    this->counts[kind].bytes -= bytes;
+}
+
+const ResourceCount& ResourceManager::count(ResourceKind kind) const{
+    return this->counts[kind];
+}
+
+void ResourceManager::print(std::ostream& out) const{
+    const ResourceCount& textures = this->counts[RESOURCE_TEXTURE];
+    const ResourceCount& buffers = this->counts[RESOURCE_BUFFER];
+    out << "resources: " << textures.live << " textures ("
+        << textures.bytes/1024 << " KB), " << buffers.live << " buffers ("
+        << buffers.bytes/1024 << " KB), " << this->counts[RESOURCE_VERTEX_ARRAY].live
+        << " vertex arrays" << std::endl;
+}
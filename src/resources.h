@@ -0,0 +1,43 @@
+#ifndef _RESOURCES_H_
+#define _RESOURCES_H_
+
+#include <cstddef>
+#include <iostream>
+
+enum ResourceKind{
+    RESOURCE_TEXTURE = 0,
+    RESOURCE_BUFFER,
+    RESOURCE_VERTEX_ARRAY,
+    RESOURCE_KINDS
+};
+
+// live GPU objects of one kind
+struct ResourceCount{
+    unsigned int live;
+    size_t bytes;
+};
+
+// Counts the live textures, buffers and vertex arrays. Their owners
+// (TextureAtlas, GlyphCache, SpriteBatch, TextBatch, StreamBuffer) call
+// track() when creating one and untrack() when deleting it, so the totals
+// are what is alive; anything still counted when the manager goes away is
+// reported as leaked. Shader programs and GPU timer queries are not counted,
+// their owners (Shader, GpuTimer) delete them without reporting.
+class ResourceManager{
+    public:
+        ResourceManager();
+        ~ResourceManager();
+
+        void track(ResourceKind kind, size_t bytes);
+        void untrack(ResourceKind kind, size_t bytes);
+        const ResourceCount& count(ResourceKind kind) const;
+        void print(std::ostream& out) const;
+
+    private:
+        ResourceCount counts[RESOURCE_KINDS];
+
+        ResourceManager(const ResourceManager&);
+        ResourceManager& operator=(const ResourceManager&);
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "scene.h"
+
+#include <iostream>
+
+// shader sources from the pack, or from the source tree without one
+// ---------------------------------------------------------------------------------------------
+static ShaderSource loadShaderSource(const AssetPack& pack, const std::string& root,
+        const char* vertexName, const char* fragmentName)
+{
+    ShaderSource source;
+    if (pack.text(vertexName, source.vertex) && pack.text(fragmentName, source.fragment))
+        return source;
+    return Shader::readSource((root + vertexName).c_str(), (root + fragmentName).c_str());
+}
+
+Scene::Scene(const AssetPack& pack, TextureAtlas& atlas, ResourceManager& resources,
+        float aspect, const std::string& root, ProgramCache* programs)
+    : spriteShaders(loadShaderSource(pack, root, "shaders/texture", "shaders/fragment"),
+            SPRITE_DEFINES, SPRITE_DEFINE_COUNT, programs),
+      textShader(loadShaderSource(pack, root, "fortext/text.vs", "fortext/text.fs"), programs),
+      spriteBatch(resources),
+      glyphCache(bakedFont, GLYPH_FONT, resources),
+      textBatch(glyphCache, resources)
+{
+    // TEXT RENDERING
+    /************************************************************/
+    glm::mat4 projection = glm::mat4(1.0f);
+    this->textShader.use();
+    this->textShader.setMat4("projection", projection);
+    // text scales are given per pixel of the original glyph size
+    this->textBatch.pixelScale = (float)GLYPH_PIXEL_SIZE/GLYPH_SDF_SIZE;
+
+    this->glyphsLoaded = this->loadGlyphs(pack);
+    /************************************************************/
+
+    // GAME RENDERING
+    /************************************************************/
+
+    // every sprite is the shared unit quad, scaled by its shape; only the
+    // GLOW variant reads the tint
+    glm::vec3 white(1.0f), glow(1.0f, 0.83f, 0.0f);
+
+    // background image
+    this->backgroundShape = SpriteShape(glm::vec2(1.0f, 1.0f), white);
+    this->backgroundImage = atlas.addImage("textures/background.png");
+
+    // player
+    float playerSizef = 0.075f;
+    this->playerShape = SpriteShape(glm::vec2(playerSizef, playerSizef*aspect), glow);
+    this->playerImage[0] = atlas.addImage("textures/player/playerRun1.png");
+    this->playerImage[1] = atlas.addImage("textures/player/playerRun2.png");
+    this->playerImage[2] = atlas.addImage("textures/player/playerRun3.png");
+
+    // zappers: two vertical styles, a horizontal one drawing the vertical
+    // image turned a quarter, and the diagonal one
+    float zapperSize = 0.075f;
+    float diagonalZapperSize = 0.2f;
+    float zapperRation = 5.5f;
+    glm::vec2 vertical(zapperSize, zapperSize*zapperRation);
+    this->zapperShape[0] = SpriteShape(vertical, glow);
+    this->zapperShape[1] = SpriteShape(vertical, glow);
+    this->zapperShape[2] = SpriteShape(glm::vec2(zapperSize*zapperRation/aspect, zapperSize*aspect),
+        glow, 1);
+    this->zapperShape[3] = SpriteShape(glm::vec2(diagonalZapperSize, diagonalZapperSize*aspect), glow);
+    for (int i = 0; i<3; i++)
+        this->zapperImage[i] = atlas.addImage("textures/zapper.png");
+    // specific to only diaganol
+    this->zapperImage[3] = atlas.addImage("textures/diagonalZapper.png");
+
+    // for coins
+    float coinSize = 0.075f;
+    this->coinShape = SpriteShape(glm::vec2(coinSize, coinSize*aspect), white);
+    this->coinImage = atlas.addImage("textures/coin.png");
+
+    // for pillars
+    float pillarWidth = 0.15f, pillarHeight = 0.5f;
+    this->pillarShape = SpriteShape(glm::vec2(pillarWidth, pillarHeight), white);
+    this->pillarImage = atlas.addImage("textures/pillar.png");
+
+    // end screens
+    this->gameOverImage = atlas.addImage("textures/gameover.png");
+    this->gameWinImage = atlas.addImage("textures/gamewin.png");
+    /************************************************************/
+}
+
+void Scene::resolve(const TextureAtlas& atlas){
+    this->backgroundTexture = atlas.region(this->backgroundImage);
+    for (int i = 0; i<3; i++)
+        this->playerTexture[i] = atlas.region(this->playerImage[i]);
+    for (int i = 0; i<ENTITY_ZAPPER_STYLES; i++)
+        this->zapperTexture[i] = atlas.region(this->zapperImage[i]);
+    this->coinTexture = atlas.region(this->coinImage);
+    this->pillarTexture = atlas.region(this->pillarImage);
+    this->gameOverTexture = atlas.region(this->gameOverImage);
+    this->gameWinTexture = atlas.region(this->gameWinImage);
+}
+
+
+// ASCII distance fields baked into the pack, else from the font cache or
+// generated with FreeType; other glyphs are rasterized when first drawn
+// ---------------------------------------------------------------------------------------------
+bool Scene::loadGlyphs(const AssetPack& pack)
+{
+    const PackEntry* baked = pack.isOpen() ? pack.find("font/sdf") : NULL;
+    if (baked && this->bakedFont.read(pack.data(*baked), baked->size))
+        return true;
+
+    std::string cache = SdfFont::cachePath("font-cache", GLYPH_FONT);
+    if (!this->bakedFont.load(cache)){
+        if (this->bakedFont.generate(GLYPH_FONT))
+            this->bakedFont.save(cache);
+    }
+    return this->glyphCache.available();
+}
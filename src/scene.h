@@ -0,0 +1,70 @@
+#ifndef _SCENE_H_
+#define _SCENE_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "shaderVariants.h"
+#include "spriteBatch.h"
+#include "textBatch.h"
+#include "glyphCache.h"
+#include "sdfFont.h"
+#include "textureAtlas.h"
+#include "assetPack.h"
+#include "resources.h"
+#include "entityStore.h"
+
+#include <string>
+
+// Everything the game draws with: shaders, batches, the glyph cache, the
+// sprite shapes and the atlas regions of every image. The app and bench_render
+// share it so that both render the same scene.
+// Usage: construct with a current context, build the atlas, then resolve().
+class Scene{
+    public:
+        ShaderVariants spriteShaders;   // one program per SpriteVariant
+        Shader textShader;
+        SpriteBatch spriteBatch;
+        SdfFont bakedFont;      // ASCII fields from the pack or the font cache
+        GlyphCache glyphCache;
+        TextBatch textBatch;
+        bool glyphsLoaded;  // false if neither the pack nor FreeType had glyphs
+
+        SpriteShape backgroundShape;
+        SpriteShape playerShape;
+        SpriteShape zapperShape[ENTITY_ZAPPER_STYLES];
+        SpriteShape coinShape;
+        SpriteShape pillarShape;
+
+        // valid after resolve()
+        AtlasRegion backgroundTexture;
+        AtlasRegion playerTexture[3];
+        AtlasRegion zapperTexture[ENTITY_ZAPPER_STYLES];
+        AtlasRegion coinTexture;
+        AtlasRegion pillarTexture;
+        AtlasRegion gameOverTexture;
+        AtlasRegion gameWinTexture;
+
+        // aspect is width/height of the framebuffer, root is where loose
+        // assets are read from when the pack does not have them; programs
+        // may be NULL to always compile the shaders
+        Scene(const AssetPack& pack, TextureAtlas& atlas, ResourceManager& resources,
+                float aspect, const std::string& root, ProgramCache* programs = NULL);
+
+        // looks the regions up once the atlas is built
+        void resolve(const TextureAtlas& atlas);
+
+    private:
+        int backgroundImage;
+        int playerImage[3];
+        int zapperImage[ENTITY_ZAPPER_STYLES];
+        int coinImage;
+        int pillarImage;
+        int gameOverImage;
+        int gameWinImage;
+
+        bool loadGlyphs(const AssetPack& pack);
+};
+
+#endif
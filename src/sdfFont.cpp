@@ -0,0 +1,329 @@
+#include "sdfFont.h"
+#include "binaryIO.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sys/stat.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+static const char cacheMagic[4] = { 'J', 'P', 'S', 'D' };
+static const uint32_t cacheVersion = 1;
+
+// farther than any glyph, still finite so the parabola math stays exact
+static const float far = 1e20f;
+
+// rounding towards -infinity and +infinity, for negative bearings
+static int floorDiv(int a, int b){
+    return a >= 0 ? a/b : -((-a + b - 1)/b);
+}
+
+static int ceilDiv(int a, int b){
+    return -floorDiv(-a, b);
+}
+
+// Squared distance transform of n samples spaced by stride (Felzenszwalb and
+// Huttenlocher, "Distance Transforms of Sampled Functions"): the lower
+// envelope of the parabolas rooted at every sample. f holds 0 on the
+// targets and far elsewhere and is overwritten with the result.
+static void transform(float* f, int n, int stride, std::vector<float>& line,
+        std::vector<int>& roots, std::vector<float>& bounds){
+    line.resize(n);
+    roots.resize(n);
+    bounds.resize(n + 1);
+    for (int q = 0; q<n; q++)
+        line[q] = f[q*stride];
+
+    int k = 0;
+    roots[0] = 0;
+    bounds[0] = -far;
+    bounds[1] = far;
+    for (int q = 1; q<n; q++){
+        float s;
+        while (true){
+            int p = roots[k];
+            s = ((line[q] + q*q) - (line[p] + p*p))/(2*q - 2*p);
+            if (s > bounds[k])
+                break;
+            k--;
+        }
+        k++;
+        roots[k] = q;
+        bounds[k] = s;
+        bounds[k + 1] = far;
+    }
+
+    k = 0;
+    for (int q = 0; q<n; q++){
+        while (bounds[k + 1] < q)
+            k++;
+        float dq = q - roots[k];
+        f[q*stride] = dq*dq + line[roots[k]];
+    }
+}
+
+// exact squared Euclidean distance to the nearest target, columns then rows
+static void transform2d(std::vector<float>& grid, int width, int height){
+    std::vector<float> line, bounds;
+    std::vector<int> roots;
+    for (int x = 0; x<width; x++)
+        transform(&grid[x], height, width, line, roots, bounds);
+    for (int y = 0; y<height; y++)
+        transform(&grid[y*width], width, 1, line, roots, bounds);
+}
+
+// the field of one oversampled glyph bitmap
+static void makeField(const FT_GlyphSlot slot, SdfGlyph& glyph){
+    const int scale = GLYPH_SDF_OVERSAMPLE;
+    const int spread = GLYPH_SDF_SPREAD;
+    const FT_Bitmap& bitmap = slot->bitmap;
+
+    glyph.advance = (slot->advance.x + scale/2)/scale;
+    glyph.field.clear();
+    if (bitmap.width == 0 || bitmap.rows == 0){
+        glyph.width = glyph.height = 0;
+        glyph.bearingX = glyph.bearingY = 0;
+        return;
+    }
+
+    // field pixels covering the bitmap, grown by the spread; y is up
+    int left = slot->bitmap_left, top = slot->bitmap_top;
+    int x0 = floorDiv(left, scale) - spread;
+    int x1 = ceilDiv(left + (int)bitmap.width, scale) + spread;
+    int y0 = ceilDiv(top, scale) + spread;
+    int y1 = floorDiv(top - (int)bitmap.rows, scale) - spread;
+    glyph.width = x1 - x0;
+    glyph.height = y0 - y1;
+    glyph.bearingX = x0;
+    glyph.bearingY = y0;
+
+    // the bitmap on a grid of the field's extent, at full resolution
+    int width = glyph.width*scale, height = glyph.height*scale;
+    int offsetX = left - x0*scale, offsetY = y0*scale - top;
+    std::vector<unsigned char> inside(width*height, 0);
+    for (unsigned int y = 0; y<bitmap.rows; y++){
+        for (unsigned int x = 0; x<bitmap.width; x++){
+            inside[(offsetY + y)*width + offsetX + x] =
+                bitmap.buffer[y*bitmap.pitch + x] >= 128;
+        }
+    }
+
+    std::vector<float> toInside(width*height), toOutside(width*height);
+    for (int i = 0; i<width*height; i++){
+        toInside[i] = inside[i] ? 0.0f : far;
+        toOutside[i] = inside[i] ? far : 0.0f;
+    }
+    transform2d(toInside, width, height);
+    transform2d(toOutside, width, height);
+
+    // the outline runs half a pixel from the centers on either side of it;
+    // each field texel averages the block it covers
+    glyph.field.resize(glyph.width*glyph.height);
+    for (int fy = 0; fy<glyph.height; fy++){
+        for (int fx = 0; fx<glyph.width; fx++){
+            float sum = 0.0f;
+            for (int y = fy*scale; y<(fy + 1)*scale; y++){
+                for (int x = fx*scale; x<(fx + 1)*scale; x++){
+                    int i = y*width + x;
+                    sum += inside[i] ? sqrtf(toOutside[i]) - 0.5f : 0.5f - sqrtf(toInside[i]);
+                }
+            }
+            float distance = sum/(scale*scale*scale);
+            float value = 0.5f + distance/(2*spread);
+            value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            glyph.field[fy*glyph.width + fx] = (unsigned char)(value*255.0f + 0.5f);
+        }
+    }
+}
+
+// appends raw values to a byte buffer, the layout doesn't depend on padding
+template <typename T>
+static void putValue(std::vector<unsigned char>& out, const T& value){
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool getValue(const unsigned char*& data, const unsigned char* end, T& value){
+    if ((size_t)(end - data) < sizeof(T))
+        return false;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+static void clearGlyph(SdfGlyph& glyph){
+    glyph.width = glyph.height = glyph.bearingX = glyph.bearingY = 0;
+    glyph.advance = 0;
+    glyph.field.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+SdfRasterizer::SdfRasterizer(){
+    this->library = NULL;
+    this->face = NULL;
+}
+
+SdfRasterizer::~SdfRasterizer(){
+    if (this->face)
+        FT_Done_Face(this->face);
+    if (this->library)
+        FT_Done_FreeType(this->library);
+}
+
+bool SdfRasterizer::open(const char* fontPath){
+    if (!this->library && FT_Init_FreeType(&this->library)){
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        this->library = NULL;
+        return false;
+    }
+    if (this->face){
+        FT_Done_Face(this->face);
+        this->face = NULL;
+    }
+    if (FT_New_Face(this->library, fontPath, 0, &this->face)){
+        std::cout << "ERROR::FREETYPE: Failed to load font " << fontPath << std::endl;
+        this->face = NULL;
+        return false;
+    }
+    FT_Set_Pixel_Sizes(this->face, 0, GLYPH_SDF_SIZE*GLYPH_SDF_OVERSAMPLE);
+    return true;
+}
+
+bool SdfRasterizer::isOpen() const{
+    return this->face != NULL;
+}
+
+bool SdfRasterizer::render(uint32_t codepoint, SdfGlyph& glyph){
+    if (!this->face || FT_Load_Char(this->face, codepoint, FT_LOAD_RENDER)){
+        clearGlyph(glyph);
+        return false;
+    }
+    makeField(this->face->glyph, glyph);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+SdfFont::SdfFont(){
+    this->loaded = false;
+    for (int c = 0; c<GLYPH_COUNT; c++)
+        clearGlyph(this->glyphs[c]);
+}
+
+bool SdfFont::generate(const char* fontPath){
+    SdfRasterizer rasterizer;
+    if (!rasterizer.open(fontPath))
+        return false;
+
+    for (int c = 0; c<GLYPH_COUNT; c++){
+        if (!rasterizer.render(c, this->glyphs[c]))
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+    }
+    this->loaded = true;
+    return true;
+}
+
+bool SdfFont::read(const unsigned char* data, size_t size){
+    const unsigned char* end = data + size;
+    uint32_t version = 0, count = 0;
+    this->loaded = size >= sizeof(cacheMagic)
+        && !memcmp(data, cacheMagic, sizeof(cacheMagic));
+    if (this->loaded)
+        data += sizeof(cacheMagic);
+    this->loaded = this->loaded
+        && getValue(data, end, version) && version == cacheVersion
+        && getValue(data, end, count) && count == GLYPH_COUNT;
+    for (int c = 0; this->loaded && c<GLYPH_COUNT; c++){
+        SdfGlyph& glyph = this->glyphs[c];
+        int32_t width = 0, height = 0, bearingX = 0, bearingY = 0;
+        uint32_t advance = 0;
+        this->loaded = getValue(data, end, width) && getValue(data, end, height)
+            && getValue(data, end, bearingX) && getValue(data, end, bearingY)
+            && getValue(data, end, advance)
+            && width >= 0 && height >= 0
+            && (size_t)(end - data) >= (size_t)width*height;
+        if (!this->loaded)
+            break;
+        glyph.width = width;
+        glyph.height = height;
+        glyph.bearingX = bearingX;
+        glyph.bearingY = bearingY;
+        glyph.advance = advance;
+        glyph.field.assign(data, data + width*height);
+        data += width*height;
+    }
+    return this->loaded;
+}
+
+void SdfFont::write(std::vector<unsigned char>& out) const{
+    out.insert(out.end(), cacheMagic, cacheMagic + sizeof(cacheMagic));
+    putValue(out, cacheVersion);
+    putValue(out, static_cast<uint32_t>(GLYPH_COUNT));
+    for (int c = 0; c<GLYPH_COUNT; c++){
+        const SdfGlyph& glyph = this->glyphs[c];
+        putValue(out, static_cast<int32_t>(glyph.width));
+        putValue(out, static_cast<int32_t>(glyph.height));
+        putValue(out, static_cast<int32_t>(glyph.bearingX));
+        putValue(out, static_cast<int32_t>(glyph.bearingY));
+        putValue(out, static_cast<uint32_t>(glyph.advance));
+        out.insert(out.end(), glyph.field.begin(), glyph.field.end());
+    }
+}
+
+bool SdfFont::load(const std::string& path){
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    std::vector<unsigned char> data;
+    unsigned char chunk[65536];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + count);
+    fclose(file);
+    return !data.empty() && this->read(&data[0], data.size());
+}
+
+bool SdfFont::save(const std::string& path) const{
+    std::vector<unsigned char> data;
+    this->write(data);
+
+    AtomicFile out(path);
+    if (!out.file){
+        std::cout << "ERROR::SDF_FONT::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+    if (!out.commit(fwrite(&data[0], data.size(), 1, out.file) == 1)){
+        std::cout << "ERROR::SDF_FONT::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string SdfFont::cachePath(const std::string& directory, const char* fontPath){
+    struct stat info;
+    int64_t size = 0, modified = 0;
+    if (stat(fontPath, &info) == 0){
+        size = info.st_size;
+        modified = info.st_mtime;
+    }
+    const int32_t settings[5] = { (int32_t)cacheVersion, GLYPH_COUNT, GLYPH_SDF_SIZE,
+        GLYPH_SDF_SPREAD, GLYPH_SDF_OVERSAMPLE };
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = hashBytes(hash, fontPath, strlen(fontPath) + 1);
+    hash = hashBytes(hash, &size, sizeof(size));
+    hash = hashBytes(hash, &modified, sizeof(modified));
+    hash = hashBytes(hash, settings, sizeof(settings));
+
+    mkdir(directory.c_str(), 0755);
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.sdf", (unsigned long long)hash);
+    return directory + name;
+}
@@ -0,0 +1,73 @@
+#ifndef _SDF_FONT_H_
+#define _SDF_FONT_H_
+
+#include "assetPack.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+// one glyph's distance field, metrics in pixels of GLYPH_SDF_SIZE
+struct SdfGlyph{
+    int width;              // of the field, spread included
+    int height;
+    int bearingX;           // to the field's left/top edge
+    int bearingY;
+    unsigned int advance;   // 1/64 pixels
+    std::vector<unsigned char> field;   // rows top down, 128 on the outline
+};
+
+// Turns glyphs of a font into signed distance fields. Outlines are
+// rasterized GLYPH_SDF_OVERSAMPLE times larger than GLYPH_SDF_SIZE, the
+// exact Euclidean distance to the outline is computed on that bitmap and
+// averaged down. A field texel stores 0.5 + distance/(2*spread), positive
+// inside, so the shader finds the outline at 0.5 at any scale.
+class SdfRasterizer{
+    public:
+        SdfRasterizer();
+        ~SdfRasterizer();
+
+        bool open(const char* fontPath);
+        bool isOpen() const;
+
+        // codepoints the font lacks come out as its missing glyph box
+        bool render(uint32_t codepoint, SdfGlyph& glyph);
+
+    private:
+        FT_LibraryRec_* library;
+        FT_FaceRec_* face;
+
+        SdfRasterizer(const SdfRasterizer&);
+        SdfRasterizer& operator=(const SdfRasterizer&);
+};
+
+// The ASCII fields, computed ahead of time: baked by the packer, or cached
+// on disk by the game without a pack. Fields are deterministic for a font
+// file and the settings.
+class SdfFont{
+    public:
+        SdfGlyph glyphs[GLYPH_COUNT];
+        bool loaded;
+
+        SdfFont();
+
+        bool generate(const char* fontPath);
+
+        // the serialized form, as stored in the pack and the cache file
+        bool read(const unsigned char* data, size_t size);
+        void write(std::vector<unsigned char>& out) const;
+
+        bool load(const std::string& path);
+        bool save(const std::string& path) const;
+
+        // cache file for fontPath under directory, named after the font's
+        // path, size and modification time and the field settings;
+        // the directory is created if missing
+        static std::string cachePath(const std::string& directory, const char* fontPath);
+};
+
+#endif
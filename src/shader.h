@@ -2,11 +2,30 @@
 #define SHADER_H
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "programCache.h"
 
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// pre-resolved uniform, look it up once with Shader::uniform()
+struct UniformHandle
+{
+    int index;  // slot in the shader's uniform table, -1 if not active
+};
+
+// vertex and fragment source of one program
+struct ShaderSource
+{
+    std::string vertex;
+    std::string fragment;
+};
 
 class Shader
 {
@@ -15,8 +34,54 @@ public:
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
+        : Shader(readSource(vertexPath, fragmentPath))
+    {
+    }
+    // from sources already in memory, e.g. an asset pack; with a cache the
+    // linked program is reused from an earlier run when it is there
+    // ------------------------------------------------------------------------
+    explicit Shader(const ShaderSource& source, ProgramCache* cache = NULL)
+    {
+        // 1. a binary of the same sources for this driver skips compiling
+        ID = cache ? cache->load(source.vertex, source.fragment) : 0;
+        if (ID)
+        {
+            reflectUniforms();
+            return;
+        }
+        const char* vShaderCode = source.vertex.c_str();
+        const char * fShaderCode = source.fragment.c_str();
+        // 2. compile shaders
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (cache)
+            cache->prepare(ID);
+        glLinkProgram(ID);
+        if (checkCompileErrors(ID, "PROGRAM") && cache)
+            cache->store(ID, source.vertex, source.fragment);
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        // 3. reflect the active uniforms so nothing is looked up by name per frame
+        reflectUniforms();
+    }
+    // retrieve the vertex/fragment source code from filePath
+    // ------------------------------------------------------------------------
+    static ShaderSource readSource(const char* vertexPath, const char* fragmentPath)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
         std::ifstream vShaderFile;
@@ -44,29 +109,14 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        ShaderSource source = { vertexCode, fragmentCode };
+        return source;
+    }
+    // the program is deleted with the object, which is why it can't be copied
+    // ------------------------------------------------------------------------
+    ~Shader()
+    {
+        glDeleteProgram(ID);
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -74,27 +124,131 @@ public:
     { 
         glUseProgram(ID); 
     }
+    // resolve a uniform once, the handle stays valid for the program's lifetime
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(const std::string &name) const
+    {
+        UniformHandle handle;
+        std::unordered_map<std::string, int>::const_iterator it = uniformIndex.find(name);
+        handle.index = it == uniformIndex.end() ? -1 : it->second;
+        return handle;
+    }
     // utility uniform functions
+    // the program must be in use; writes of an unchanged value are skipped
+    // ------------------------------------------------------------------------
+    void setBool(UniformHandle handle, bool value) const
+    {
+        setInt(handle, (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(UniformHandle handle, int value) const
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1i(uniforms[handle.index].location, value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(UniformHandle handle, float value) const
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1f(uniforms[handle.index].location, value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(UniformHandle handle, const glm::vec3 &value) const
+    {
+        if (changed(handle, &value[0], sizeof(value)))
+            glUniform3fv(uniforms[handle.index].location, 1, &value[0]);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(UniformHandle handle, const glm::mat4 &mat) const
+    {
+        if (changed(handle, &mat[0][0], sizeof(mat)))
+            glUniformMatrix4fv(uniforms[handle.index].location, 1, GL_FALSE, &mat[0][0]);
+    }
+    // by name: one hash lookup instead of a glGetUniformLocation round trip
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        setBool(uniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        setInt(uniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        setFloat(uniform(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string &name, const glm::vec3 &value) const
+    { 
+        setVec3(uniform(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    {
+        setMat4(uniform(name), mat);
     }
 
 private:
-    // utility function for checking shader compilation/linking errors.
+    Shader(const Shader&);
+    Shader& operator=(const Shader&);
+
+    struct UniformSlot
+    {
+        int location;
+        GLenum type;
+        bool hasValue;      // false until the first write
+        float value[16];    // last value written, big enough for a mat4
+    };
+    mutable std::vector<UniformSlot> uniforms;   // value cache is not logical state
+    std::unordered_map<std::string, int> uniformIndex;
+
+    // build the uniform table from the linked program
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        int count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        for (int i = 0; i < count; i++)
+        {
+            char name[256];
+            int size;
+            GLenum type;
+            glGetActiveUniform(ID, i, sizeof(name), NULL, &size, &type, name);
+            // arrays are reported as "name[0]", store them under the plain name too
+            std::string uniformName(name);
+            std::string::size_type bracket = uniformName.find('[');
+            if (bracket != std::string::npos)
+                uniformName = uniformName.substr(0, bracket);
+
+            UniformSlot slot;
+            slot.location = glGetUniformLocation(ID, name);
+            slot.type = type;
+            slot.hasValue = false;
+            uniformIndex[uniformName] = uniforms.size();
+            uniforms.push_back(slot);
+        }
+    }
+    // compare against the cached value and remember the new one
+    // ------------------------------------------------------------------------
+    bool changed(UniformHandle handle, const void* value, size_t bytes) const
+    {
+        if (handle.index < 0)
+            return false;
+        UniformSlot& slot = uniforms[handle.index];
+        if (slot.hasValue && memcmp(slot.value, value, bytes) == 0)
+            return false;
+        memcpy(slot.value, value, bytes);
+        slot.hasValue = true;
+        return true;
+    }
+
+    // utility function for checking shader compilation/linking errors,
+    // returns true on success
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -116,6 +270,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "shaderVariants.h"
+
+// #version has to stay the first line, defines go right below it
+static std::string injectStage(const std::string& stage, const std::string& lines){
+    std::string::size_type start = stage.find("#version");
+    if (start == std::string::npos)
+        return lines + stage;
+    std::string::size_type end = stage.find('\n', start);
+    if (end == std::string::npos)
+        return stage + "\n" + lines;
+    return stage.substr(0, end + 1) + lines + stage.substr(end + 1);
+}
+
+ShaderSource ShaderVariants::inject(const ShaderSource& source, const std::string& lines){
+    ShaderSource result = { injectStage(source.vertex, lines), injectStage(source.fragment, lines) };
+    return result;
+}
+
+ShaderVariants::ShaderVariants(const ShaderSource& source, const char* const defines[],
+        unsigned int defineCount, ProgramCache* cache){
+    for (unsigned int mask = 0; mask < (1u << defineCount); mask++){
+        std::string lines;
+        for (unsigned int i = 0; i<defineCount; i++){
+            if (mask & (1u << i))
+                lines += std::string("#define ") + defines[i] + "\n";
+        }
+        this->programs.push_back(new Shader(inject(source, lines), cache));
+    }
+}
+
+ShaderVariants::~ShaderVariants(){
+    for (unsigned int i = 0; i<this->programs.size(); i++)
+        delete this->programs[i];
+}
+
+unsigned int ShaderVariants::count() const{
+    return this->programs.size();
+}
+
+const Shader& ShaderVariants::get(unsigned int mask) const{
+    return *this->programs[mask];
+}
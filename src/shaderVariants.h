@@ -0,0 +1,33 @@
+#ifndef _SHADER_VARIANTS_H_
+#define _SHADER_VARIANTS_H_
+
+#include "shader.h"
+#include "programCache.h"
+
+#include <string>
+#include <vector>
+
+// Specialized programs compiled from one source. Bit i of a variant mask
+// adds "#define <defines[i]>" to both stages right after #version, so the
+// shader can drop code with #ifdef instead of branching on a uniform.
+// Every combination is built up front so nothing compiles mid-frame.
+class ShaderVariants{
+    public:
+        ShaderVariants(const ShaderSource& source, const char* const defines[],
+                unsigned int defineCount, ProgramCache* cache = NULL);
+        ~ShaderVariants();
+
+        unsigned int count() const;
+        const Shader& get(unsigned int mask) const;
+
+        // source with the given lines inserted after #version
+        static ShaderSource inject(const ShaderSource& source, const std::string& lines);
+
+    private:
+        std::vector<Shader*> programs;      // indexed by mask
+
+        ShaderVariants(const ShaderVariants&);
+        ShaderVariants& operator=(const ShaderVariants&);
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "simulation.h"
+#include "replay.h"
+#include "binaryIO.h"
+
+#include <algorithm>
+
+static const float playerInitx = -0.7f;
+static const float playerInity = -0.7f;
+
+// entities live in [-entityRange, entityRange] vertically
+static const float entityRange = 0.75f;
+static const float entitySpeed = 0.45f;        // vertical, per second
+static const float entityRecycleX = -1.15f;
+// chunks are placed once their start is this close to the screen, far
+// enough that nothing pops in at the edge
+static const float spawnX = 1.2f;
+
+// the generator draws from its own stream, split off the game's
+static uint64_t levelSeed(Random& rng){
+    uint64_t high = rng.next();
+    return (high << 32) | rng.next();
+}
+
+World::World(const char* playerName, uint64_t seed, bool endless):
+    game(playerName, seed),
+    background1(glm::vec3(0.0f, 0.0f, 0.0f)),
+    background2(glm::vec3(2.0f, 0.0f, 0.0f)),
+    player(glm::vec3(playerInitx, playerInity, 0.0f), 0.9f),
+    level(glm::vec3(1.0f, -0.4f, 0.0f)),
+    levels(levelSeed(game.rng), DifficultyCurve::classic(), game.levelLength){
+
+    this->game.endless = endless;
+    this->level.snap();
+    // the first chunk starts at the first pillar
+    this->nextChunkX = this->level.currentCoordinates.x;
+    this->spawnChunks();
+
+    this->backgroundShiftSpeed = -this->levels.curve().at(this->game.level).speed;
+    this->time = 0.0;
+    this->steps = 0;
+    this->recorder = NULL;
+    this->profiler = NULL;
+    this->accumulator = 0.0f;
+}
+
+float World::advance(const SimInput& input, float frameTime){
+    if (frameTime > SIM_MAX_FRAME)
+        frameTime = SIM_MAX_FRAME;
+
+    this->accumulator += frameTime;
+    while (this->accumulator >= SIM_STEP && !this->isOver()){
+        this->step(input);
+        this->accumulator -= SIM_STEP;
+    }
+    return this->accumulator/SIM_STEP;
+}
+
+void World::step(const SimInput& input){
+    ProfileScope scope(this->profiler, "step");
+    const float dt = SIM_STEP;
+    glm::mat4 model;
+
+    if (this->recorder)
+        this->recorder->record(input);
+
+    this->background1.beginStep();
+    this->background2.beginStep();
+    this->level.beginStep();
+    this->player.beginStep();
+    this->entities.beginStep();
+
+    this->backgroundShiftSpeed = -this->levels.curve().at(this->game.level).speed;
+    float shift = dt*this->backgroundShiftSpeed;
+
+    if (input.fly)
+        this->player.fly(model);
+
+    // backgrounds
+    this->background1.SpriteTranslate(shift, 0, 0);
+    if (this->background1.currentCoordinates.x <= -2.0f){
+        this->background1.SpriteTranslate(4.0f, 0.0f, 0.0f);
+        this->background1.snap();
+    }
+    this->background2.SpriteTranslate(shift, 0, 0);
+    if (this->background2.currentCoordinates.x <= -2.0f){
+        this->background2.SpriteTranslate(4.0f, 0.0f, 0.0f);
+        this->background2.snap();
+    }
+
+    // levelChanger
+    this->level.SpriteTranslate(shift, 0, 0);
+    this->level.check(this->game, this->player);
+
+    // player
+    this->player.setModel(model, 0, 0, 0);
+    this->player.activateDrop(model, dt);
+    this->player.animate(dt);
+    if (!this->player.isFlying)
+        this->player.enableSmoothstep = 0.0;
+    this->player.playerAcceleration = this->player.gravityAcceleration;
+
+    // obstacles and coins
+    this->entities.scroll(shift);
+    this->nextChunkX += shift;
+    this->recycleEntities();
+    this->spawnChunks();
+    this->entities.bounce(dt, entityRange);
+    this->collideEntities();
+
+    // updating distance travelled
+    if (this->game.started)
+        this->game.curLengthTravelled -= shift;
+
+    this->time += dt;
+    this->steps++;
+}
+
+void World::spawn(const ChunkEntry& entry, float x){
+    unsigned int i = this->entities.spawn(entry.type, x, entry.y*entityRange,
+        entry.moving ? entitySpeed : 0.0f);
+    this->broadphase.insert(this->entities, i);
+}
+
+void World::spawnChunks(){
+    LevelChunk chunk;
+    while (this->nextChunkX < spawnX){
+        this->levels.next(chunk);
+        for (unsigned int k = 0; k<chunk.count; k++)
+            this->spawn(chunk.entries[k], this->nextChunkX + chunk.entries[k].x);
+        this->nextChunkX += LEVEL_CHUNK_LENGTH;
+    }
+}
+
+void World::recycleEntities(){
+    EntityStore& e = this->entities;
+
+    // the ones past the edge are at the front of the x order
+    this->recycled.clear();
+    this->broadphase.popBehind(e, entityRecycleX, this->recycled);
+    for (unsigned int r = 0; r<this->recycled.size(); r++)
+        e.despawn(this->recycled[r]);
+}
+
+void World::collideEntities(){
+    ProfileScope scope(this->profiler, "collision");
+    EntityStore& e = this->entities;
+    float px = this->player.currentCoordinates.x;
+    float reach = CollisionKernel::reach();
+
+    // narrow phase only for what overlaps the player horizontally
+    this->candidates.clear();
+    this->broadphase.query(e, px - reach, px + reach, this->candidates);
+    this->collision.gather(e, this->candidates);
+    this->hits.clear();
+    this->collision.test(px, this->player.currentCoordinates.y, this->hits);
+
+    for (unsigned int h = 0; h<this->hits.size(); h++){
+        unsigned int i = this->hits[h];
+        if (isZapper(e.type[i])){
+            if (this->game.verbose)
+                std::cout<<"Collision!"<<std::endl;
+            this->game.zapperCollision = true;
+        } else {
+            this->game.score++;
+            this->broadphase.remove(e, i);
+            e.despawn(i);
+        }
+    }
+}
+
+bool World::isOver() const{
+    return this->game.zapperCollision || this->game.isGameWon;
+}
+
+static void hashVec3(uint64_t& hash, const glm::vec3& v){
+    hash = hashBytes(hash, &v.x, sizeof(float));
+    hash = hashBytes(hash, &v.y, sizeof(float));
+    hash = hashBytes(hash, &v.z, sizeof(float));
+}
+
+uint64_t World::checksum() const{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    uint64_t steps = this->steps;
+    uint32_t score = this->game.score, level = this->game.level;
+    unsigned char flags[3] = { this->game.zapperCollision, this->game.isGameWon,
+        this->game.started };
+
+    hash = hashBytes(hash, &steps, sizeof(steps));
+    hash = hashBytes(hash, &score, sizeof(score));
+    hash = hashBytes(hash, &level, sizeof(level));
+    hash = hashBytes(hash, flags, sizeof(flags));
+    hash = hashBytes(hash, &this->game.curLengthTravelled, sizeof(float));
+    hashVec3(hash, this->player.currentCoordinates);
+    hash = hashBytes(hash, &this->player.playerSpeed, sizeof(float));
+    hashVec3(hash, this->level.currentCoordinates);
+    const EntityStore& e = this->entities;
+    for (unsigned int k = 0; k<e.size(); k++){
+        unsigned int i = e.live[k];
+        hash = hashBytes(hash, &i, sizeof(i));
+        hash = hashBytes(hash, &e.type[i], 1);
+        hash = hashBytes(hash, &e.x[i], sizeof(float));
+        hash = hashBytes(hash, &e.y[i], sizeof(float));
+    }
+    return hash;
+}
@@ -0,0 +1,76 @@
+#ifndef _SIMULATION_H_
+#define _SIMULATION_H_
+
+#include "transformations.h"
+#include "entityStore.h"
+#include "broadphase.h"
+#include "collision.h"
+#include "levelGenerator.h"
+#include "profiler.h"
+
+#include <cstdint>
+#include <vector>
+
+class Replay;
+
+// length of one simulation step in seconds, independent of the frame rate
+const float SIM_STEP = 1.0f/120.0f;
+// longest frame we try to catch up on, avoids spiralling after a stall
+const float SIM_MAX_FRAME = 0.25f;
+
+// input sampled once per rendered frame and held for its steps
+struct SimInput{
+    bool fly;
+};
+
+// Everything the game simulates. Advanced in fixed steps; the renderer
+// draws each sprite between its previous and current step positions.
+class World{
+    public:
+        Game game;
+        Sprite background1;
+        Sprite background2;
+        Player player;
+        levelChanger level;
+        EntityStore entities;   // zappers and coins
+        LevelGenerator levels;  // upcoming chunks, start() moves it off this thread
+        float backgroundShiftSpeed;
+        double time;            // simulated seconds
+        unsigned long steps;    // simulated steps
+
+        Replay* recorder;       // when set, every step's input is appended
+        Profiler* profiler;     // when set, steps and collisions are timed
+
+        // the seed drives every random decision, equal seeds and inputs
+        // give bit-identical runs; an endless run has no last level
+        World(const char* playerName, uint64_t seed, bool endless = false);
+
+        // runs every whole step that fits in frameTime and returns the
+        // interpolation factor for rendering in [0, 1)
+        float advance(const SimInput& input, float frameTime);
+
+        void step(const SimInput& input);
+
+        bool isOver() const;
+
+        // FNV-1a over the simulated state, to compare two runs
+        uint64_t checksum() const;
+
+    private:
+        float accumulator;
+        Broadphase broadphase;              // entities in x order
+        CollisionKernel collision;
+        std::vector<unsigned int> recycled; // reused every step
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> hits;
+        float nextChunkX;                   // where the next chunk starts
+
+        void spawn(const ChunkEntry& entry, float x);
+        // places chunks until the next one starts past the right edge
+        void spawnChunks();
+        // entities that scrolled off the left edge are despawned
+        void recycleEntities();
+        void collideEntities();
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "spriteBatch.h"
+
+#include <glm/packing.hpp>
+
+const char* const SPRITE_DEFINES[] = { "GLOW", "ALPHA_TEST" };
+
+SpriteShape::SpriteShape(){
+    this->halfSize = 0;
+    this->tint[0] = this->tint[1] = this->tint[2] = 255;
+    this->tint[3] = 0;
+}
+
+SpriteShape::SpriteShape(const glm::vec2& halfSize, const glm::vec3& tint,
+        unsigned int quarterTurns){
+    this->halfSize = glm::packHalf2x16(halfSize);
+    uint32_t color = glm::packUnorm4x8(glm::vec4(tint, 0.0f));
+    for (int i = 0; i<3; i++)
+        this->tint[i] = (color >> (8*i)) & 0xff;
+    this->tint[3] = quarterTurns & 3;
+}
+
+SpriteBatch::SpriteBatch(ResourceManager& resources)
+    : instances(resources), resources(resources){
+    this->drawCalls = 0;
+    this->spriteCount = 0;
+    this->usedGroups = 0;
+    for (unsigned int i = 0; i<SPRITE_VARIANTS; i++)
+        this->projProgram[i] = 0;
+
+    // core profile draws need a vertex array even without vertex data
+    glGenVertexArrays(1, &this->VAO);
+    glBindVertexArray(this->VAO);
+    for (unsigned int i = 0; i<4; i++){
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+    this->resources.track(RESOURCE_VERTEX_ARRAY, 0);
+}
+
+SpriteBatch::~SpriteBatch(){
+    glDeleteVertexArrays(1, &this->VAO);
+    this->resources.untrack(RESOURCE_VERTEX_ARRAY, 0);
+}
+
+SpriteBatch::Group& SpriteBatch::findGroup(unsigned int variant, unsigned int texture){
+    // only the trailing group may grow, so layering follows submission order
+    if (this->usedGroups > 0){
+        Group& last = this->groups[this->usedGroups-1];
+        if (last.variant == variant && last.texture == texture)
+            return last;
+    }
+
+    if (this->usedGroups == this->groups.size())
+        this->groups.push_back(Group());
+
+    Group& group = this->groups[this->usedGroups++];
+    group.variant = variant;
+    group.texture = texture;
+    group.instances.clear();
+    return group;
+}
+
+void SpriteBatch::draw(const SpriteShape& shape, unsigned int texture,
+        const glm::vec3& position, unsigned int variant, const glm::vec4& uvRect){
+    SpriteInstance instance;
+    instance.offset = glm::vec2(position.x, position.y);
+    for (int i = 0; i<4; i++)
+        instance.uvRect[i] = (uint16_t)(glm::clamp(uvRect[i], 0.0f, 1.0f)*65535.0f + 0.5f);
+    instance.halfSize = shape.halfSize;
+    for (int i = 0; i<4; i++)
+        instance.tint[i] = shape.tint[i];
+    this->findGroup(variant, texture).instances.push_back(instance);
+}
+
+void SpriteBatch::draw(const SpriteShape& shape, const AtlasRegion& region,
+        const glm::vec3& position, unsigned int variant){
+    this->draw(shape, region.texture, position, variant, region.uvRect);
+}
+
+void SpriteBatch::flush(RenderContext& context, const ShaderVariants& shaders, const glm::mat4& proj){
+    this->drawCalls = 0;
+    this->spriteCount = 0;
+
+    // pack all groups back to back so a single upload covers the frame
+    this->staging.clear();
+    for (unsigned int i = 0; i<this->usedGroups; i++)
+        this->staging.insert(this->staging.end(),
+            this->groups[i].instances.begin(), this->groups[i].instances.end());
+
+    if (this->staging.empty()){
+        this->usedGroups = 0;
+        return;
+    }
+
+    // the instance attributes below source the buffer this leaves bound
+    unsigned long start = this->instances.write(context, &this->staging[0],
+        this->staging.size()*sizeof(SpriteInstance));
+
+    unsigned long first = 0;
+    for (unsigned int i = 0; i<this->usedGroups; i++){
+        Group& group = this->groups[i];
+        unsigned long base = start + first*sizeof(SpriteInstance);
+
+        // both are no-ops while the variant stays the same
+        const Shader& shader = shaders.get(group.variant);
+        context.useProgram(shader);
+        if (this->projProgram[group.variant] != shader.ID){
+            this->projProgram[group.variant] = shader.ID;
+            this->projUniform[group.variant] = shader.uniform("proj");
+        }
+        shader.setMat4(this->projUniform[group.variant], proj);
+        context.setBlend(!(group.variant & SPRITE_ALPHA_TEST));
+
+        context.bindVertexArray(this->VAO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+            (void*)(base + offsetof(SpriteInstance, offset)));
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(SpriteInstance),
+            (void*)(base + offsetof(SpriteInstance, uvRect)));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(SpriteInstance),
+            (void*)(base + offsetof(SpriteInstance, halfSize)));
+        glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(SpriteInstance),
+            (void*)(base + offsetof(SpriteInstance, tint)));
+
+        context.bindTexture(group.texture);
+        context.drawArraysInstanced(GL_TRIANGLES, 0, 6, group.instances.size());
+
+        this->drawCalls++;
+        this->spriteCount += group.instances.size();
+        first += group.instances.size();
+    }
+
+    this->instances.endFrame();
+    this->usedGroups = 0;
+}
@@ -0,0 +1,102 @@
+#ifndef _SPRITE_BATCH_H_
+#define _SPRITE_BATCH_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "shaderVariants.h"
+#include "module.h"
+#include "textureAtlas.h"
+#include "streamBuffer.h"
+#include "resources.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// bits of a sprite shader variant, each one a #define in shaders/texture
+enum SpriteVariant{
+    SPRITE_PLAIN = 0,
+    SPRITE_GLOW = 1,        // radial smoothstep glow
+    SPRITE_ALPHA_TEST = 2   // cut-out drawn without blending
+};
+
+// names of the SpriteVariant bits, for ShaderVariants
+extern const char* const SPRITE_DEFINES[];
+const unsigned int SPRITE_DEFINE_COUNT = 2;
+// variant masks, one program each: every combination of the bits
+static const unsigned int SPRITE_VARIANTS = 1 << SPRITE_DEFINE_COUNT;
+
+// Size, texture orientation and glow tint of a kind of sprite, packed the
+// way SpriteInstance carries them.
+struct SpriteShape{
+    uint32_t halfSize;      // half width and height as two half floats
+    uint8_t tint[4];        // glow colour, a -> quarter turns of the uvs
+
+    SpriteShape();
+    SpriteShape(const glm::vec2& halfSize, const glm::vec3& tint,
+            unsigned int quarterTurns = 0);
+};
+
+// per-instance data read by shaders/texture (locations 0 to 3); there is
+// no per-vertex data, the unit quad's corners come from gl_VertexID
+struct SpriteInstance{
+    glm::vec2 offset;   // model translation of the sprite
+    uint16_t uvRect[4]; // xy -> uv origin, zw -> uv size, normalized shorts
+    uint32_t halfSize;  // from the SpriteShape
+    uint8_t tint[4];
+};
+
+// Collects every sprite submitted during a frame and draws each run of
+// consecutive sprites sharing a variant and texture with one
+// glDrawArraysInstanced call. Groups keep submission order, which is also
+// the layering; neighbouring groups of the same variant share the program
+// and blend state.
+class SpriteBatch{
+    public:
+        unsigned int drawCalls;     // draw calls issued by the last flush
+        unsigned int spriteCount;   // sprites drawn by the last flush
+
+        // GL objects are counted in resources
+        explicit SpriteBatch(ResourceManager& resources);
+        ~SpriteBatch();
+
+        void draw(const SpriteShape& shape, unsigned int texture,
+                const glm::vec3& position, unsigned int variant,
+                const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+        void draw(const SpriteShape& shape, const AtlasRegion& region,
+                const glm::vec3& position, unsigned int variant);
+
+        // shaders holds one program per SpriteVariant mask
+        void flush(RenderContext& context, const ShaderVariants& shaders, const glm::mat4& proj);
+
+    private:
+        struct Group{
+            unsigned int variant;
+            unsigned int texture;
+            std::vector<SpriteInstance> instances;
+        };
+
+        // groups are reused between frames so that steady state
+        // submission does not allocate; only [0, usedGroups) are live
+        std::vector<Group> groups;
+        unsigned int usedGroups;
+
+        std::vector<SpriteInstance> staging;
+        StreamBuffer instances;
+        unsigned int VAO;           // instance attributes only
+        ResourceManager& resources;
+
+        // "proj" of every variant, resolved against the program it was
+        // last flushed with
+        unsigned int projProgram[SPRITE_VARIANTS];
+        UniformHandle projUniform[SPRITE_VARIANTS];
+
+        Group& findGroup(unsigned int variant, unsigned int texture);
+
+        SpriteBatch(const SpriteBatch&);
+        SpriteBatch& operator=(const SpriteBatch&);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>
+
+// Bounded single producer, single consumer ring. One thread only pushes and
+// one only pops; neither locks, each index is written by one side and read
+// by the other. One slot stays empty to tell full from empty, so it holds
+// Capacity - 1 items. Capacity must be a power of two.
+template <typename T, unsigned int Capacity>
+class SpscQueue{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+        "SpscQueue capacity must be a power of two");
+
+    public:
+        SpscQueue(): head(0), tail(0){}
+
+        // producer side, false when full
+        bool push(const T& item){
+            unsigned int tail = this->tail.load(std::memory_order_relaxed);
+            unsigned int next = (tail + 1) & (Capacity - 1);
+            if (next == this->head.load(std::memory_order_acquire))
+                return false;
+            this->slots[tail] = item;
+            this->tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side, false when empty
+        bool pop(T& item){
+            unsigned int head = this->head.load(std::memory_order_relaxed);
+            if (head == this->tail.load(std::memory_order_acquire))
+                return false;
+            item = this->slots[head];
+            this->head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+            return true;
+        }
+
+    private:
+        T slots[Capacity];
+        // on their own cache lines so the two threads don't share one
+        alignas(64) std::atomic<unsigned int> head;     // next slot to pop
+        alignas(64) std::atomic<unsigned int> tail;     // next slot to push
+
+        SpscQueue(const SpscQueue&);
+        SpscQueue& operator=(const SpscQueue&);
+};
+
+#endif
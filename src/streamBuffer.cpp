@@ -0,0 +1,142 @@
+#include "streamBuffer.h"
+
+#include <cstring>
+
+StreamBuffer::StreamBuffer(ResourceManager& resources, unsigned long regionBytes)
+    : resources(resources){
+    this->stalls = 0;
+    this->usePersistent = false;
+    this->regionBytes = regionBytes;
+    for (unsigned int i = 0; i<STREAM_REGIONS; i++){
+        this->buffers[i] = 0;
+        this->fences[i] = 0;
+    }
+    this->mapped = NULL;
+    this->region = 0;
+    this->used = 0;
+    this->regionReady = false;
+    this->allocated = false;
+}
+
+StreamBuffer::~StreamBuffer(){
+    this->deleteObjects();
+}
+
+bool StreamBuffer::persistent() const{
+    return this->usePersistent;
+}
+
+unsigned int StreamBuffer::buffer() const{
+    return this->usePersistent ? this->buffers[0] : this->buffers[this->region];
+}
+
+void StreamBuffer::allocate(RenderContext& context, unsigned long regionBytes){
+    this->release(context);
+    this->regionBytes = regionBytes;
+    this->allocated = true;
+    // nothing is pending on new storage
+    this->regionReady = true;
+    this->used = 0;
+
+    this->usePersistent = GLAD_GL_ARB_buffer_storage != 0;
+    if (this->usePersistent){
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &this->buffers[0]);
+        context.bindArrayBuffer(this->buffers[0]);
+        glBufferStorage(GL_ARRAY_BUFFER, regionBytes*STREAM_REGIONS, NULL, flags);
+        this->resources.track(RESOURCE_BUFFER, regionBytes*STREAM_REGIONS);
+        this->mapped = static_cast<unsigned char*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, regionBytes*STREAM_REGIONS, flags));
+        if (this->mapped)
+            return;
+        // advertised but not mappable, orphan like GL 3.3 does
+        this->release(context);
+        this->usePersistent = false;
+    }
+
+    glGenBuffers(STREAM_REGIONS, this->buffers);
+    for (unsigned int i = 0; i<STREAM_REGIONS; i++){
+        context.bindArrayBuffer(this->buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, regionBytes, NULL, GL_STREAM_DRAW);
+        this->resources.track(RESOURCE_BUFFER, regionBytes);
+    }
+}
+
+void StreamBuffer::release(RenderContext& context){
+    // deleting a bound buffer unbinds it behind the context's back
+    context.bindArrayBuffer(0);
+    this->deleteObjects();
+}
+
+void StreamBuffer::deleteObjects(){
+    // a persistent buffer holds every region
+    unsigned long bytes = this->usePersistent ? this->regionBytes*STREAM_REGIONS : this->regionBytes;
+    for (unsigned int i = 0; i<STREAM_REGIONS; i++){
+        if (this->buffers[i]){
+            glDeleteBuffers(1, &this->buffers[i]);
+            this->resources.untrack(RESOURCE_BUFFER, bytes);
+        }
+        this->buffers[i] = 0;
+        if (this->fences[i])
+            glDeleteSync(this->fences[i]);
+        this->fences[i] = 0;
+    }
+    this->mapped = NULL;
+}
+
+void StreamBuffer::prepareRegion(RenderContext& context){
+    this->regionReady = true;
+    if (!this->usePersistent){
+        // the draws of the region's last frame keep the old storage
+        context.bindArrayBuffer(this->buffers[this->region]);
+        glBufferData(GL_ARRAY_BUFFER, this->regionBytes, NULL, GL_STREAM_DRAW);
+        return;
+    }
+
+    GLsync& fence = this->fences[this->region];
+    if (!fence)
+        return;
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED){
+        this->stalls++;
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+            ;
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+unsigned long StreamBuffer::write(RenderContext& context, const void* data, unsigned long bytes){
+    unsigned long offset = (this->used + STREAM_ALIGNMENT - 1) & ~(STREAM_ALIGNMENT - 1);
+    if (!this->allocated || offset + bytes > this->regionBytes){
+        // draws already issued keep reading the old buffers
+        unsigned long size = this->regionBytes > 0 ? this->regionBytes : STREAM_ALIGNMENT;
+        while (size < offset + bytes)
+            size *= 2;
+        this->allocate(context, size);
+        offset = 0;
+    } else if (!this->regionReady){
+        this->prepareRegion(context);
+    }
+
+    if (this->usePersistent){
+        offset += this->region*this->regionBytes;
+        memcpy(this->mapped + offset, data, bytes);
+        context.bindArrayBuffer(this->buffers[0]);
+        this->used = offset - this->region*this->regionBytes + bytes;
+    } else {
+        context.bindArrayBuffer(this->buffers[this->region]);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, bytes, data);
+        this->used = offset + bytes;
+    }
+    return offset;
+}
+
+void StreamBuffer::endFrame(){
+    if (!this->allocated || !this->regionReady)
+        return;
+    if (this->usePersistent)
+        this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    this->region = (this->region + 1) % STREAM_REGIONS;
+    this->used = 0;
+    this->regionReady = false;
+}
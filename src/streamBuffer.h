@@ -0,0 +1,64 @@
+#ifndef _STREAM_BUFFER_H_
+#define _STREAM_BUFFER_H_
+
+#include <glad/glad.h>
+
+#include "module.h"
+#include "resources.h"
+
+// regions the CPU cycles through, so it writes one while the GPU reads
+// the ones before
+const unsigned int STREAM_REGIONS = 3;
+// offsets returned by write() are multiples of this
+const unsigned long STREAM_ALIGNMENT = 16;
+
+// Vertex data written anew every frame. With GL_ARB_buffer_storage the
+// regions are parts of one buffer mapped once, persistent and coherent:
+// writes are plain copies, and a fence placed after a region's draws is
+// waited on before the region is written again, which only blocks if the
+// GPU is STREAM_REGIONS frames behind. On plain GL 3.3 every region is a
+// buffer of its own, orphaned before its first write of the frame. Either
+// way nothing waits for the draws of the previous frame.
+// A region grows to fit the largest frame; GL objects are made on the
+// first write, so it can be constructed before there is a context, and
+// counted in the ResourceManager.
+class StreamBuffer{
+    public:
+        unsigned int stalls;    // writes that had to wait for the GPU
+
+        explicit StreamBuffer(ResourceManager& resources, unsigned long regionBytes = 64*1024);
+        ~StreamBuffer();
+
+        bool persistent() const;
+
+        // copies data into this frame's region and returns the offset to
+        // source it from in buffer(), which is left bound to GL_ARRAY_BUFFER
+        unsigned long write(RenderContext& context, const void* data, unsigned long bytes);
+        // the buffer holding the data of the last write()
+        unsigned int buffer() const;
+
+        // after the draws that read this frame's writes
+        void endFrame();
+
+    private:
+        bool usePersistent;
+        unsigned long regionBytes;
+        unsigned int buffers[STREAM_REGIONS];   // one mapped buffer, or one per region
+        GLsync fences[STREAM_REGIONS];
+        unsigned char* mapped;
+        unsigned int region;
+        unsigned long used;                     // bytes of the region written this frame
+        bool regionReady;                       // waited for or orphaned this frame
+        bool allocated;
+        ResourceManager& resources;
+
+        void allocate(RenderContext& context, unsigned long regionBytes);
+        void release(RenderContext& context);
+        void deleteObjects();
+        void prepareRegion(RenderContext& context);
+
+        StreamBuffer(const StreamBuffer&);
+        StreamBuffer& operator=(const StreamBuffer&);
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "textBatch.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// dirtyFrom of a field with nothing to lay out
+static const unsigned int clean = ~0u;
+
+// the two triangles of a glyph with its baseline origin at x, y; false if
+// the glyph has no pixels
+static bool glyphQuad(const Character& ch, float x, float y, float scale,
+        const glm::vec3& color, TextVertex quad[6])
+{
+    float xpos = x + ch.Bearing.x * scale;
+    float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+
+    float w = ch.Size.x * scale;
+    float h = ch.Size.y * scale;
+    if (!(w > 0.0f && h > 0.0f && ch.TextureID))
+        return false;
+
+    // glyph rectangle in its page
+    float u0 = ch.UVRect.x, u1 = ch.UVRect.x + ch.UVRect.z;
+    float v0 = ch.UVRect.y, v1 = ch.UVRect.y + ch.UVRect.w;
+    quad[0].vertex = glm::vec4(xpos,     ypos + h,   u0, v0);
+    quad[1].vertex = glm::vec4(xpos,     ypos,       u0, v1);
+    quad[2].vertex = glm::vec4(xpos + w, ypos,       u1, v1);
+
+    quad[3].vertex = glm::vec4(xpos,     ypos + h,   u0, v0);
+    quad[4].vertex = glm::vec4(xpos + w, ypos,       u1, v1);
+    quad[5].vertex = glm::vec4(xpos + w, ypos + h,   u1, v0);
+    for (int i = 0; i<6; i++)
+        quad[i].color = color;
+    return true;
+}
+
+TextBatch::TextBatch(GlyphCache& glyphs, ResourceManager& resources)
+    : glyphs(glyphs), stream(resources), resources(resources){
+    this->drawCalls = 0;
+    this->fieldGlyphs = 0;
+    this->pixelScale = 1.0f;
+    this->fieldQuadsAllocated = 0;
+    this->uploadFirst = clean;
+    this->uploadLast = 0;
+
+    // configure VAOs for texture quads, the per-frame one is pointed at
+    // its stream region in flush()
+    // -----------------------------------
+    glGenVertexArrays(1, &this->VAO);
+    glBindVertexArray(this->VAO);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    glGenVertexArrays(1, &this->fieldVAO);
+    glGenBuffers(1, &this->fieldVBO);
+    glBindVertexArray(this->fieldVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->fieldVBO);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    pointAttributes(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    this->resources.track(RESOURCE_VERTEX_ARRAY, 0);
+    this->resources.track(RESOURCE_VERTEX_ARRAY, 0);
+    this->resources.track(RESOURCE_BUFFER, 0);
+}
+
+TextBatch::~TextBatch(){
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteVertexArrays(1, &this->fieldVAO);
+    glDeleteBuffers(1, &this->fieldVBO);
+    this->resources.untrack(RESOURCE_VERTEX_ARRAY, 0);
+    this->resources.untrack(RESOURCE_VERTEX_ARRAY, 0);
+    this->resources.untrack(RESOURCE_BUFFER, this->fieldQuadsAllocated*6*sizeof(TextVertex));
+}
+
+// TextVertex attributes at base of the bound GL_ARRAY_BUFFER
+void TextBatch::pointAttributes(unsigned long base){
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)base);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex),
+        (void*)(base + offsetof(TextVertex, color)));
+}
+
+void TextBatch::add(const std::string& text, float x, float y, float scale,
+        const glm::vec3& color){
+    scale *= this->pixelScale;
+    // iterate through all characters
+    std::string::const_iterator c = text.begin();
+    while (c != text.end())
+    {
+        const Character& ch = this->glyphs.get(GlyphCache::decodeUtf8(c, text.end()));
+
+        TextVertex quad[6];
+        if (glyphQuad(ch, x, y, scale, color, quad)){
+            this->vertices.insert(this->vertices.end(), quad, quad + 6);
+            this->vertexTextures.push_back(ch.TextureID);
+        }
+        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+        x += ch.Advance/64.0f * scale;
+    }
+}
+
+int TextBatch::addField(float x, float y, float scale, const glm::vec3& color,
+        unsigned int capacity){
+    TextField field;
+    field.x = x;
+    field.y = y;
+    field.scale = scale;
+    field.color = color;
+    field.previous = -1;
+    field.first = this->fieldTextures.size();
+    field.capacity = capacity;
+    field.pen.assign(capacity + 1, x);
+    field.length = 0;
+    field.dirtyFrom = clean;
+    field.evictions = this->glyphs.evicted;
+    field.number = 0;
+    field.hasNumber = false;
+    field.visible = true;
+    this->fields.push_back(field);
+
+    this->fieldVertices.resize(this->fieldVertices.size() + capacity*6);
+    this->fieldTextures.resize(this->fieldTextures.size() + capacity, 0);
+    return this->fields.size() - 1;
+}
+
+int TextBatch::addFieldAfter(int previous, unsigned int capacity){
+    const TextField& after = this->fields[previous];
+    int field = this->addField(after.x, after.y, after.scale, after.color, capacity);
+    this->fields[field].previous = previous;
+    return field;
+}
+
+void TextBatch::setText(int field, const std::string& text){
+    this->setField(field, text.data(), text.size());
+    this->fields[field].hasNumber = false;
+}
+
+void TextBatch::setNumber(int field, long value){
+    TextField& numberField = this->fields[field];
+    if (numberField.hasNumber && numberField.number == value)
+        return;
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%ld", value);
+    this->setField(field, digits, length);
+    numberField.number = value;
+    numberField.hasNumber = true;
+}
+
+void TextBatch::setVisible(int field, bool visible){
+    this->fields[field].visible = visible;
+}
+
+void TextBatch::setField(int field, const char* text, size_t length){
+    TextField& changed = this->fields[field];
+    if (changed.text.compare(0, std::string::npos, text, length) == 0)
+        return;
+
+    // characters up to the first changed byte keep their quads
+    size_t same = 0;
+    while (same < length && same < changed.text.size() && changed.text[same] == text[same])
+        same++;
+    while (same > 0 && same < length && (text[same] & 0xc0) == 0x80)
+        same--;
+    unsigned int characters = 0;
+    for (size_t i = 0; i<same; i++)
+        if ((text[i] & 0xc0) != 0x80)
+            characters++;
+
+    changed.text.assign(text, length);
+    changed.dirtyFrom = std::min(changed.dirtyFrom, characters);
+}
+
+void TextBatch::layoutFields(){
+    // fields are laid out in order, so the one a field follows is done first;
+    // glyphs loaded here may evict those of fields laid out earlier, which
+    // are then laid out again with everything else in use this frame
+    bool again = true;
+    while (again){
+        for (unsigned int i = 0; i<this->fields.size(); i++){
+            TextField& field = this->fields[i];
+            if (field.evictions != this->glyphs.evicted)
+                field.dirtyFrom = 0;
+            if (field.previous >= 0){
+                const TextField& previous = this->fields[field.previous];
+                float origin = previous.pen[previous.length];
+                if (field.pen[0] != origin){
+                    field.pen[0] = origin;
+                    field.dirtyFrom = 0;
+                }
+            }
+            if (field.dirtyFrom != clean)
+                this->layoutField(field);
+        }
+
+        again = false;
+        for (unsigned int i = 0; i<this->fields.size(); i++)
+            again = again || this->fields[i].evictions != this->glyphs.evicted;
+    }
+}
+
+void TextBatch::layoutField(TextField& field){
+    field.evictions = this->glyphs.evicted;
+    unsigned int from = std::min(field.dirtyFrom, field.length);
+    field.dirtyFrom = clean;
+
+    // skip the characters that stay
+    std::string::const_iterator c = field.text.begin();
+    for (unsigned int i = 0; i<from && c != field.text.end(); i++)
+        GlyphCache::decodeUtf8(c, field.text.end());
+
+    float scale = field.scale*this->pixelScale;
+    float x = field.pen[from];
+    unsigned int i = from;
+    for (; c != field.text.end() && i < field.capacity; i++){
+        const Character& ch = this->glyphs.get(GlyphCache::decodeUtf8(c, field.text.end()));
+
+        unsigned int quad = field.first + i;
+        TextVertex* vertices = &this->fieldVertices[quad*6];
+        if (glyphQuad(ch, x, field.y, scale, field.color, vertices)){
+            this->fieldTextures[quad] = ch.TextureID;
+        } else {
+            // blank quads may join a draw, so they must not cover anything
+            std::fill(vertices, vertices + 6, TextVertex());
+            this->fieldTextures[quad] = 0;
+        }
+        x += ch.Advance/64.0f * scale;
+        field.pen[i + 1] = x;
+    }
+    field.length = i;
+
+    if (i > from){
+        this->uploadFirst = std::min(this->uploadFirst, field.first + from);
+        this->uploadLast = std::max(this->uploadLast, field.first + i);
+        this->fieldGlyphs += i - from;
+    }
+}
+
+void TextBatch::drawFields(RenderContext& context){
+    // only the quads rewritten since the last frame reach the buffer
+    unsigned int quads = this->fieldTextures.size();
+    context.bindArrayBuffer(this->fieldVBO);
+    if (quads > this->fieldQuadsAllocated){
+        glBufferData(GL_ARRAY_BUFFER, quads*6*sizeof(TextVertex), &this->fieldVertices[0], GL_DYNAMIC_DRAW);
+        // same buffer, new size
+        this->resources.untrack(RESOURCE_BUFFER, this->fieldQuadsAllocated*6*sizeof(TextVertex));
+        this->resources.track(RESOURCE_BUFFER, quads*6*sizeof(TextVertex));
+        this->fieldQuadsAllocated = quads;
+    } else if (this->uploadFirst < this->uploadLast){
+        glBufferSubData(GL_ARRAY_BUFFER, this->uploadFirst*6*sizeof(TextVertex),
+            (this->uploadLast - this->uploadFirst)*6*sizeof(TextVertex),
+            &this->fieldVertices[this->uploadFirst*6]);
+    }
+    this->uploadFirst = clean;
+    this->uploadLast = 0;
+
+    context.bindVertexArray(this->fieldVAO);
+
+    // adjacent quads on a page form a run, blank quads join any run; all
+    // runs of a page go in one draw
+    for (unsigned int i = 0; i<this->fieldRuns.size(); i++){
+        this->fieldRuns[i].first.clear();
+        this->fieldRuns[i].count.clear();
+    }
+    unsigned int runFirst = 0, runEnd = 0, runTexture = 0;
+    for (unsigned int f = 0; f<this->fields.size(); f++){
+        const TextField& field = this->fields[f];
+        if (!field.visible)
+            continue;
+        for (unsigned int quad = field.first; quad<field.first + field.length; quad++){
+            unsigned int texture = this->fieldTextures[quad];
+            if (quad == runEnd && (texture == 0 || runTexture == 0 || texture == runTexture)){
+                runEnd++;
+                if (texture)
+                    runTexture = texture;
+                continue;
+            }
+            this->addFieldRun(runFirst, runEnd, runTexture);
+            runFirst = quad;
+            runEnd = quad + 1;
+            runTexture = texture;
+        }
+    }
+    this->addFieldRun(runFirst, runEnd, runTexture);
+
+    for (unsigned int i = 0; i<this->fieldRuns.size(); i++){
+        const FieldRuns& runs = this->fieldRuns[i];
+        if (runs.first.empty())
+            continue;
+        context.bindTexture(runs.texture);
+        context.multiDrawArrays(GL_TRIANGLES, &runs.first[0], &runs.count[0], runs.first.size());
+        this->drawCalls++;
+    }
+}
+
+void TextBatch::addFieldRun(unsigned int first, unsigned int end, unsigned int texture){
+    if (texture == 0 || first == end)
+        return;
+    unsigned int i = 0;
+    while (i < this->fieldRuns.size() && this->fieldRuns[i].texture != texture)
+        i++;
+    if (i == this->fieldRuns.size()){
+        this->fieldRuns.push_back(FieldRuns());
+        this->fieldRuns[i].texture = texture;
+    }
+    this->fieldRuns[i].first.push_back(first*6);
+    this->fieldRuns[i].count.push_back((end - first)*6);
+}
+
+void TextBatch::flush(RenderContext& context, const Shader& shader){
+    this->drawCalls = 0;
+    this->fieldGlyphs = 0;
+    this->layoutFields();
+    // glyphs first seen this frame reach their pages before the draws
+    this->glyphs.upload(context);
+    this->glyphs.endFrame();
+    if (this->vertices.empty() && this->fields.empty())
+        return;
+
+    // activate corresponding render state	
+    context.useProgram(shader);
+    context.setBlend(true);
+    if (!this->fields.empty())
+        this->drawFields(context);
+    if (this->vertices.empty())
+        return;
+
+    // the whole frame in one write to the stream, which leaves it bound
+    unsigned long base = this->stream.write(context, &this->vertices[0],
+        this->vertices.size()*sizeof(TextVertex));
+    context.bindVertexArray(this->VAO);
+    pointAttributes(base);
+
+    // one draw per run of quads sharing a glyph page, normally just one
+    unsigned int first = 0;
+    unsigned int quads = this->vertexTextures.size();
+    while (first < quads){
+        unsigned int last = first + 1;
+        while (last < quads && this->vertexTextures[last] == this->vertexTextures[first])
+            last++;
+        context.bindTexture(this->vertexTextures[first]);
+        context.drawArrays(GL_TRIANGLES, first*6, (last - first)*6);
+        this->drawCalls++;
+        first = last;
+    }
+
+    this->stream.endFrame();
+    this->vertices.clear();
+    this->vertexTextures.clear();
+}
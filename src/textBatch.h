@@ -0,0 +1,109 @@
+#ifndef _TEXT_BATCH_H_
+#define _TEXT_BATCH_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "module.h"
+#include "glyphCache.h"
+#include "streamBuffer.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// vertex layout read by fortext/text.vs
+struct TextVertex{
+    glm::vec4 vertex;   // <vec2 pos, vec2 tex>
+    glm::vec3 color;
+};
+
+// Lays out every string queued during a frame into one vertex buffer
+// and draws them all with one upload and one draw per glyph page.
+// Text is UTF-8, glyphs come from the cache as they are first used.
+//
+// Text that stays on screen goes into fields instead: a field keeps its
+// quads in a second buffer and is only laid out again from the first
+// character that changed, so a score going from 1290 to 1300 rewrites two
+// quads and a label never again. A field placed after another continues
+// where that one ends, which keeps labels and the numbers next to them
+// apart. Fields are laid out again in full when the glyph cache evicted
+// anything since, their quads may point at a reused cell.
+class TextBatch{
+    public:
+        GlyphCache& glyphs;
+        float pixelScale;           // text scale units per glyph pixel
+        unsigned int drawCalls;     // draw calls issued by the last flush
+        unsigned int fieldGlyphs;   // field characters laid out by the last flush
+
+        // GL objects are counted in resources
+        TextBatch(GlyphCache& glyphs, ResourceManager& resources);
+        ~TextBatch();
+
+        void add(const std::string& text, float x, float y, float scale,
+                const glm::vec3& color);
+
+        // returns a field id; capacity is in characters, longer text is cut
+        int addField(float x, float y, float scale, const glm::vec3& color,
+                unsigned int capacity);
+        // on the same line as previous, from where its text ends
+        int addFieldAfter(int previous, unsigned int capacity);
+        void setText(int field, const std::string& text);
+        // no work at all if the value did not change
+        void setNumber(int field, long value);
+        void setVisible(int field, bool visible);
+
+        // draws the visible fields, then the text added this frame
+        void flush(RenderContext& context, const Shader& shader);
+
+    private:
+        struct TextField{
+            float x;
+            float y;
+            float scale;
+            glm::vec3 color;
+            int previous;           // field this one follows, or -1
+            unsigned int first;     // first quad in the field buffer
+            unsigned int capacity;  // quads
+            std::string text;
+            std::vector<float> pen; // x before each character, and after the last
+            unsigned int length;    // characters laid out
+            unsigned int dirtyFrom; // first character to lay out again
+            unsigned int evictions; // glyph cache evictions at the last layout
+            long number;
+            bool hasNumber;         // number is the value of text
+            bool visible;
+        };
+
+        std::vector<TextVertex> vertices;
+        std::vector<unsigned int> vertexTextures;  // glyph page of every quad
+        unsigned int VAO;
+        StreamBuffer stream;
+
+        std::vector<TextField> fields;
+        std::vector<TextVertex> fieldVertices;     // copy of the field buffer
+        std::vector<unsigned int> fieldTextures;   // glyph page of every quad, 0 if empty
+        unsigned int fieldVAO;
+        unsigned int fieldVBO;
+        unsigned int fieldQuadsAllocated;          // quads the field buffer holds
+        unsigned int uploadFirst;                  // quads rewritten since the last upload
+        unsigned int uploadLast;
+        // vertex ranges of the visible fields, gathered per glyph page
+        struct FieldRuns{
+            unsigned int texture;
+            std::vector<int> first;
+            std::vector<int> count;
+        };
+        std::vector<FieldRuns> fieldRuns;
+        ResourceManager& resources;
+
+        void setField(int field, const char* text, size_t length);
+        void layoutFields();
+        void layoutField(TextField& field);
+        void drawFields(RenderContext& context);
+        void addFieldRun(unsigned int first, unsigned int end, unsigned int texture);
+        static void pointAttributes(unsigned long base);
+};
+
+#endif
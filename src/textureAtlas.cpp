@@ -0,0 +1,303 @@
+#include "textureAtlas.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+TextureAtlas::TextureAtlas(ResourceManager& resources, int pageSize, int padding,
+        const std::string& root) : resources(resources){
+    this->pageSize = pageSize;
+    this->padding = padding;
+    this->root = root;
+    this->uploadBuffer = 0;
+    this->uploadBytes = 0;
+}
+
+TextureAtlas::~TextureAtlas(){
+    if (!this->pages.empty())
+        glDeleteTextures(this->pages.size(), &this->pages[0]);
+    for (unsigned int p = 0; p<this->pages.size(); p++)
+        this->resources.untrack(RESOURCE_TEXTURE, this->pageMemory[p]);
+    if (this->uploadBuffer){
+        glDeleteBuffers(1, &this->uploadBuffer);
+        this->resources.untrack(RESOURCE_BUFFER, this->uploadBytes);
+    }
+}
+
+int TextureAtlas::addImage(const char* imageName){
+    std::map<std::string, int>::iterator it = this->pathIds.find(imageName);
+    if (it != this->pathIds.end())
+        return it->second;
+
+    // the header is enough to pack the image, decoding happens on the loader
+    Entry entry;
+    int nrChannels;
+    int id = this->entries.size();
+    std::string imagePath = this->root + imageName;
+    if (!this->pages.empty()){
+        std::cout << "Atlas: " << imageName << " is not in the asset pack" << std::endl;
+        entry.width = entry.height = 0;
+        entry.uploaded = true;
+        this->regions.push_back(AtlasRegion());
+    } else if (stbi_info(imagePath.c_str(), &entry.width, &entry.height, &nrChannels)){
+        entry.uploaded = false;
+        this->loader.load(id, imagePath, this->padding);
+    } else {
+        std::cout << "Failed to load texture " << imagePath << std::endl;
+        entry.width = entry.height = 0;
+        entry.uploaded = true;
+    }
+
+    this->entries.push_back(entry);
+    this->pathIds[imageName] = id;
+    return id;
+}
+
+int TextureAtlas::addBitmap(int width, int height, const unsigned char* data,
+        int pitch, const char* name){
+    Entry entry;
+    entry.width = width;
+    entry.height = height;
+    entry.uploaded = width == 0 || height == 0;
+    std::vector<unsigned char> pixels(width*height*4);
+    for (int y = 0; y<height; y++){
+        for (int x = 0; x<width; x++){
+            unsigned char* texel = &pixels[(y*width + x)*4];
+            texel[0] = texel[1] = texel[2] = 255;
+            texel[3] = data[y*pitch + x];
+        }
+    }
+    if (!entry.uploaded)
+        extrudeImage(&pixels[0], width, height, this->padding, entry.pixels);
+
+    if (name)
+        this->pathIds[name] = this->entries.size();
+    this->entries.push_back(entry);
+    return this->entries.size() - 1;
+}
+
+bool TextureAtlas::load(const AssetPack& pack){
+    const PackEntry* table = pack.find("atlas/regions");
+    if (!table || table->kind != PACK_DATA || this->pages.size())
+        return false;
+
+    // every page level goes straight from the pack to GL, nothing to decode
+    std::vector<glm::ivec2> pageSizes;
+    for (unsigned int p = 0; ; p++){
+        const PackEntry* page = pack.find("atlas/page" + std::to_string(p));
+        if (!page || page->kind != PACK_TEXTURE)
+            break;
+
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, page->levels - 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        const unsigned char* level = pack.data(*page);
+        int width = page->width, height = page->height;
+        for (unsigned int l = 0; l<page->levels; l++){
+            glTexImage2D(GL_TEXTURE_2D, l, GL_RGBA, width, height, 0, GL_RGBA,
+                GL_UNSIGNED_BYTE, level);
+            level += width*height*4;
+            width = std::max(width/2, 1);
+            height = std::max(height/2, 1);
+        }
+        this->pages.push_back(texture);
+        this->pageMemory.push_back(page->size);
+        this->resources.track(RESOURCE_TEXTURE, page->size);
+        this->pagePending.push_back(0);
+        pageSizes.push_back(glm::ivec2(page->width, page->height));
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const PackRegion* packed = reinterpret_cast<const PackRegion*>(pack.data(*table));
+    unsigned int count = table->size/sizeof(PackRegion);
+    for (unsigned int i = 0; i<count; i++){
+        Entry entry;
+        entry.width = packed[i].width;
+        entry.height = packed[i].height;
+        entry.uploaded = true;
+        entry.page = packed[i].page;
+        entry.x = packed[i].x;
+        entry.y = packed[i].y;
+
+        AtlasRegion region = AtlasRegion();
+        if (entry.page < (int)this->pages.size()){
+            glm::vec2 pageSize(pageSizes[entry.page]);
+            region.texture = this->pages[entry.page];
+            region.width = entry.width;
+            region.height = entry.height;
+            region.uvRect = glm::vec4(entry.x/pageSize.x, entry.y/pageSize.y,
+                entry.width/pageSize.x, entry.height/pageSize.y);
+        }
+
+        this->pathIds[packed[i].name] = this->entries.size();
+        this->entries.push_back(entry);
+        this->regions.push_back(region);
+    }
+    return true;
+}
+
+int TextureAtlas::find(const char* name) const{
+    std::map<std::string, int>::const_iterator it = this->pathIds.find(name);
+    return it == this->pathIds.end() ? -1 : it->second;
+}
+
+void TextureAtlas::build(){
+    // already loaded from a pack
+    if (!this->pages.empty())
+        return;
+
+    int maxSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    int size = std::min(this->pageSize, maxSize);
+
+    std::vector<glm::ivec2> sizes(this->entries.size());
+    for (unsigned int i = 0; i<this->entries.size(); i++)
+        sizes[i] = glm::ivec2(this->entries[i].width, this->entries[i].height);
+    std::vector<AtlasPlacement> placements;
+    std::vector<glm::ivec2> pageExtent = layoutAtlas(sizes, size, this->padding, placements);
+    for (unsigned int i = 0; i<this->entries.size(); i++){
+        this->entries[i].page = placements[i].page;
+        this->entries[i].x = placements[i].x;
+        this->entries[i].y = placements[i].y;
+    }
+
+    // allocate every page, trimmed to the area actually used; images are
+    // copied in as they arrive
+    this->regions.resize(this->entries.size());
+    this->pages.resize(pageExtent.size());
+    this->pagePending.assign(pageExtent.size(), 0);
+    glGenTextures(this->pages.size(), this->pages.empty() ? NULL : &this->pages[0]);
+    for (unsigned int p = 0; p<this->pages.size(); p++){
+        int width = pageExtent[p].x, height = pageExtent[p].y;
+        std::vector<unsigned char> blank(width*height*4, 0);
+
+        glBindTexture(GL_TEXTURE_2D, this->pages[p]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // complete without mips until every image is in
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &blank[0]);
+        // a full mip chain adds a third
+        this->pageMemory.push_back(blank.size()*4/3);
+        this->resources.track(RESOURCE_TEXTURE, this->pageMemory.back());
+
+        for (unsigned int i = 0; i<this->entries.size(); i++){
+            const Entry& entry = this->entries[i];
+            if (entry.page != (int)p)
+                continue;
+            AtlasRegion region;
+            region.texture = this->pages[p];
+            region.width = entry.width;
+            region.height = entry.height;
+            region.uvRect = glm::vec4(
+                entry.x / static_cast<float>(width), entry.y / static_cast<float>(height),
+                entry.width / static_cast<float>(width), entry.height / static_cast<float>(height));
+            this->regions[i] = region;
+            if (!entry.uploaded)
+                this->pagePending[p]++;
+        }
+    }
+
+    glGenBuffers(1, &this->uploadBuffer);
+    this->resources.track(RESOURCE_BUFFER, 0);
+    for (unsigned int i = 0; i<this->entries.size(); i++){
+        if (!this->entries[i].pixels.empty())
+            this->upload(this->entries[i]);
+    }
+    this->update();
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TextureAtlas::upload(Entry& entry){
+    int pad = this->padding;
+    int width = entry.width + 2*pad;
+    int height = entry.height + 2*pad;
+    GLsizeiptr size = width*height*4;
+
+    glBindTexture(GL_TEXTURE_2D, this->pages[entry.page]);
+
+    // orphan the buffer so the copy never waits for the previous transfer,
+    // the driver moves the pixels to the texture asynchronously
+    if (!entry.pixels.empty()){
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->uploadBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        this->resources.untrack(RESOURCE_BUFFER, this->uploadBytes);
+        this->resources.track(RESOURCE_BUFFER, size);
+        this->uploadBytes = size;
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped){
+            memcpy(mapped, &entry.pixels[0], size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, entry.x - pad, entry.y - pad, width, height,
+                GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    std::vector<unsigned char>().swap(entry.pixels);
+    entry.uploaded = true;
+    if (--this->pagePending[entry.page] == 0){
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+bool TextureAtlas::update(){
+    if (this->pages.empty())
+        return false;
+
+    bool touched = false;
+    LoadedImage image;
+    while (this->loader.poll(image)){
+        Entry& entry = this->entries[image.tag];
+        bool matches = image.width == entry.width + 2*this->padding
+            && image.height == entry.height + 2*this->padding;
+        if (image.failed || !matches){
+            // the region stays blank, the page still gets its mipmaps
+            image.pixels.clear();
+            if (!image.failed)
+                std::cout << "Atlas: decoded image does not match its header" << std::endl;
+        }
+        entry.pixels.swap(image.pixels);
+        this->upload(entry);
+        touched = true;
+    }
+    return touched;
+}
+
+void TextureAtlas::finish(){
+    while (this->loader.pending() > 0){
+        if (!this->update())
+            std::this_thread::yield();
+    }
+}
+
+bool TextureAtlas::ready(int id) const{
+    return this->entries[id].uploaded;
+}
+
+bool TextureAtlas::ready() const{
+    return this->loader.pending() == 0;
+}
+
+const AtlasRegion& TextureAtlas::region(int id) const{
+    return this->regions[id];
+}
+
+unsigned int TextureAtlas::pageCount() const{
+    return this->pages.size();
+}
@@ -0,0 +1,99 @@
+#ifndef _TEXTURE_ATLAS_H_
+#define _TEXTURE_ATLAS_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "atlasLayout.h"
+#include "imageLoader.h"
+#include "assetPack.h"
+#include "resources.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// where an image ended up after packing
+struct AtlasRegion{
+    unsigned int texture;   // GL texture of the atlas page
+    glm::vec4 uvRect;       // xy -> uv origin, zw -> uv size
+    int width;              // size in texels
+    int height;
+};
+
+// Packs images and bitmaps into a few RGBA pages at load time.
+// Usage: add everything, call build() once, then look regions up by id.
+// Images decode on worker threads from the moment they are added; only
+// their size is needed to pack them, so regions are valid right after
+// build() and their pixels stream in as update() uploads finished images.
+// Until then a region samples as transparent.
+// Alternatively load() takes pages baked by the asset packer, mip chains
+// included; every packed image is then already registered and
+// addImage() just returns its id.
+// Pages and the upload buffer are counted in the ResourceManager.
+class TextureAtlas{
+    public:
+        // root is prepended to image names when reading them from disk
+        TextureAtlas(ResourceManager& resources, int pageSize = ATLAS_PAGE_SIZE,
+                int padding = ATLAS_PADDING, const std::string& root = "");
+        ~TextureAtlas();
+
+        // returns a region id, loading a name twice returns the same id
+        // and queues the image for decoding
+        int addImage(const char* imageName);
+        // single channel bitmaps are stored as white with alpha,
+        // a name makes them findable
+        int addBitmap(int width, int height, const unsigned char* data,
+                int pitch, const char* name = NULL);
+
+        // uploads the pages of an asset pack, false if it has no atlas
+        bool load(const AssetPack& pack);
+        // region id of an image or named bitmap, -1 if unknown
+        int find(const char* name) const;
+
+        void build();
+        // uploads decoded images through a pixel buffer and mipmaps pages
+        // once complete; returns true if GL bindings were changed
+        bool update();
+        // blocks until every image is uploaded
+        void finish();
+
+        // whether the pixels of a region are uploaded
+        bool ready(int id) const;
+        bool ready() const;
+
+        const AtlasRegion& region(int id) const;
+        unsigned int pageCount() const;
+
+    private:
+        struct Entry{
+            int width;
+            int height;
+            std::vector<unsigned char> pixels; // RGBA with extruded padding, freed after upload
+            bool uploaded;
+            int page;
+            int x;
+            int y;
+        };
+
+        int pageSize;
+        int padding;
+        std::string root;
+        std::vector<Entry> entries;
+        std::map<std::string, int> pathIds;
+        std::vector<AtlasRegion> regions;
+        std::vector<unsigned int> pages;
+        std::vector<size_t> pageMemory;       // mip chain included
+        std::vector<int> pagePending;       // entries of a page not yet uploaded
+        unsigned int uploadBuffer;          // GL_PIXEL_UNPACK_BUFFER
+        size_t uploadBytes;
+        ImageLoader loader;
+        ResourceManager& resources;
+
+        void upload(Entry& entry);
+
+        TextureAtlas(const TextureAtlas&);
+        TextureAtlas& operator=(const TextureAtlas&);
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "transformations.h"
 
+
 void translate(glm::mat4& matrix, float x, float y, float z){
     matrix = glm::translate(matrix, glm::vec3(x, y, z));
 }
@@ -1,17 +1,14 @@
 #ifndef _TRANSFORMATIONS_H_
 #define _TRANSFORMATIONS_H_
 
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <stb_image.h>
+// game logic only, no GL or GLFW in here so it also builds headless
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include <cstdlib>
 #include <cmath>
+#include <iostream>
 
-#include "shader.h"
-#include "module.h"
+#include "random.h"
 
 void translate(glm::mat4& matrix, float x, float y, float z);
 
@@ -22,7 +19,6 @@ class Game{
         unsigned int score;
         unsigned int level;
         float spriteDist;
-        int spriteCount;
         bool zapperCollision;
         bool isGameWon;
         int numSpritesPerLevel;
@@ -30,20 +26,16 @@ class Game{
         float levelLength;
         float curLengthTravelled;
         bool started;
+        bool verbose;   // log collisions to stdout
+        bool endless;   // levels go on past the third
 
-        float frameSpeeds[4];
+        Random rng;     // every random decision of a run comes from here
 
-        Game(const char* playerName){
+        Game(const char* playerName, uint64_t seed){
+            this->rng.seed(seed);
             this->score = 0;
             this->level = 0;
-            {
-                this->frameSpeeds[0] = 0.45;
-                this->frameSpeeds[1] = 0.50;
-                this->frameSpeeds[2] = 0.70;
-                this->frameSpeeds[3] = 0.80;
-            }
             this->spriteDist = 0.8f;
-            this->spriteCount = 3;
             this->zapperCollision = false;
             this->isGameWon = false;
             this->numSpritesPerLevel = 15;
@@ -51,6 +43,8 @@ class Game{
             this->levelLength = this->numSpritesPerLevel*this->spriteDist;
             this->curLengthTravelled = 0;
             this->started = false;
+            this->verbose = true;
+            this->endless = false;
         }
 };
 
@@ -58,6 +52,7 @@ class Sprite{
     public:
         glm::mat4 SpriteModel;
         glm::vec3 currentCoordinates;
+        glm::vec3 previousCoordinates;  // at the start of the current step
         float enableSmoothstep;
 
         Sprite(){
@@ -68,12 +63,29 @@ class Sprite{
             this->enableSmoothstep = 0.0;
 
             this->currentCoordinates = currentCoordinates;
+            this->previousCoordinates = currentCoordinates;
             this->SpriteModel = glm::mat4(1.0f);
             translate(this->SpriteModel, this->currentCoordinates.x,
                 this->currentCoordinates.y,
                 this->currentCoordinates.z);
         }
 
+        // called before every simulation step
+        void beginStep(){
+            this->previousCoordinates = this->currentCoordinates;
+        }
+
+        // teleports (wrapping, respawning) must not be interpolated
+        void snap(){
+            this->previousCoordinates = this->currentCoordinates;
+        }
+
+        // position to draw at, alpha is how far we are into the next step
+        glm::vec3 interpolatedCoordinates(float alpha) const{
+            return glm::mix(this->previousCoordinates,
+                this->currentCoordinates, alpha);
+        }
+
         void SpriteTranslate(float x, float y, float z){
             translate(this->SpriteModel, x, y, z);
             this->currentCoordinates.x += x;
@@ -101,7 +113,7 @@ class Player: public Sprite{
     public:
         float ceilingHeight;
         float initFloor;
-        float lastTime;
+        float runningTime;
         int playerRunningIndex;
         float textureChangeTime;
         int playerFlyingIndex;
@@ -109,8 +121,6 @@ class Player: public Sprite{
         float playerSpeed;
         float gravityAcceleration;
         float verticalAcceleration;
-        float timeInterval;
-        float lastUpdatedTime;
         float playerAcceleration;
 
         Player(glm::vec3 currentCoordinates, float ceilingHeight){
@@ -118,12 +128,13 @@ class Player: public Sprite{
 
             initFloor = currentCoordinates.y;
             this->currentCoordinates = currentCoordinates;
+            this->previousCoordinates = currentCoordinates;
             this->SpriteModel = glm::mat4(1.0f);
             translate(this->SpriteModel, this->currentCoordinates.x,
                 this->currentCoordinates.y,
                 this->currentCoordinates.z);
             this->ceilingHeight = ceilingHeight;
-            this->lastTime = glfwGetTime();
+            this->runningTime = 0.0f;
             this->playerRunningIndex = 0;
             this->textureChangeTime = 0.1;
             this->playerFlyingIndex = 2;
@@ -131,8 +142,6 @@ class Player: public Sprite{
             this->playerSpeed = 0.00f;
             this->verticalAcceleration = 9.0f;
             this->gravityAcceleration = -5.0f;
-            this->timeInterval = 0.0f;
-            this->lastUpdatedTime = glfwGetTime();
             this->playerAcceleration = 0.0f;
         }
 
@@ -161,285 +170,36 @@ class Player: public Sprite{
                 this->isFlying = true;
         }
 
-        void updateTime(){
-            this->timeInterval = 
-                glfwGetTime() - this->lastUpdatedTime;
-            this->lastUpdatedTime = glfwGetTime();
-            // std::cout<<timeInterval<<std::endl;
-        }
-
         void fly(glm::mat4& model){
             this->playerAcceleration = this->verticalAcceleration;
             this->enableSmoothstep = 1.0f;
         }
 
-        void activateDrop(glm::mat4& model){
-            this->updateTime();
-
+        void activateDrop(glm::mat4& model, float dt){
             if (this->playerAcceleration < 0){
                 this->enableSmoothstep = 0.0f;
             }
 
             this->playerSpeed += 
-                this->timeInterval*this->playerAcceleration;
+                dt*this->playerAcceleration;
             this->setModel(model, 0,
-                    this->playerSpeed*this->timeInterval
-                        + 0.5*this->playerAcceleration*this->timeInterval*this->timeInterval,
+                    this->playerSpeed*dt
+                        + 0.5*this->playerAcceleration*dt*dt,
             0);
         }
-};
-
-void identify(glm::mat4& matrix);
-
-class Zapper: public Sprite{
-    public:
-        int textureStyle;
-        /*
-            0 -> vertical
-            1 -> vertical and moving up and down
-            2 -> horizontal
-            3 -> diagonal
-        */
-        bool goingUpwards; 
-        float verticalSpeed;
-
-        void genInitPos(){
-            float rand01 = rand() / static_cast<float>(RAND_MAX);
-            rand01 = 2*rand01 - 1;
-            rand01 *= 0.75;
-            this->currentCoordinates.y = rand01;
-        }
-
-        Zapper(glm::vec3 currentCoordinates){
-            this->enableSmoothstep = 1.0;
-
-            this->currentCoordinates = currentCoordinates;
-            this->SpriteModel = glm::mat4(1.0f);
-
-            this->textureStyle = rand()%4;
-            this->genInitPos();
-
-            translate(this->SpriteModel, this->currentCoordinates.x,
-                this->currentCoordinates.y,
-                this->currentCoordinates.z);
-
-            // only for textureStyle == 1
-            this->goingUpwards = true;
-            this->verticalSpeed = 0.0075f;
-        }
-
-        void genAgain(){
-            this->textureStyle = rand()%4;
-            this->genInitPos();
-
-            this->SpriteModel = glm::mat4(1.0f);
-
-            translate(this->SpriteModel, this->currentCoordinates.x,
-                this->currentCoordinates.y,
-                this->currentCoordinates.z);
-        }
-
-        void doVerticalTranslation(){
-            if (this->goingUpwards){
-                this->SpriteTranslate(0, this->verticalSpeed, 0);
-            } else {
-                this->SpriteTranslate(0, -this->verticalSpeed, 0);
-            }
-
-            if (this->currentCoordinates.y >= 0.75){
-                this->goingUpwards = false;
-            } 
-            
-            if (this->currentCoordinates.y <= -0.75){
-                this->goingUpwards = true;
-            }
-        }
-
-        void checkCollision(Game& game, const Player& player){
-
-            if (this->textureStyle == 1 || this->textureStyle == 0){
-                if (fabs(player.currentCoordinates.x - 
-                    currentCoordinates.x) < 0.075f
-                    &&
-                    fabs(player.currentCoordinates.y - 
-                    currentCoordinates.y) < 0.40f){
-                    std::cout<<"Collision!"<<std::endl;
-                    game.zapperCollision = true;
-                }
-            }
-
-            if (this->textureStyle == 2){
-                if (fabs(player.currentCoordinates.x - 
-                    currentCoordinates.x) < 0.245
-                    &&
-                    fabs(player.currentCoordinates.y - 
-                    currentCoordinates.y) < 0.11){
-                    std::cout<<"Collision!"<<std::endl;
-                    game.zapperCollision = true;
-                }
-            }
-
-            if (this->textureStyle == 3){
-                float leftX = this->currentCoordinates.x - 0.2f;
-                float rightX = this->currentCoordinates.x + 0.2f;
-
-                float leftY = this->currentCoordinates.y - 0.26;
-                float rightY = this->currentCoordinates.y + 0.26;
-
-                float zapperLength = 
-                    2*sqrt(0.2*0.2 + 0.26*0.26);
-
-                float playerDistance = 
-                    sqrt(
-                        (player.currentCoordinates.x - leftX)*
-                            (player.currentCoordinates.x - leftX) + 
-                        (player.currentCoordinates.y - leftY)*
-                            (player.currentCoordinates.y - leftY)
-                    ) + 
-                    sqrt(
-                        (player.currentCoordinates.x - rightX)*
-                            (player.currentCoordinates.x - rightX) + 
-                        (player.currentCoordinates.y - rightY)*
-                            (player.currentCoordinates.y - rightY)
-                    );
-
-                if (fabs(playerDistance - zapperLength) < 0.05){
-                    std::cout<<"Collision!"<<std::endl;
-                    game.zapperCollision = true;
-                }
-            }     
-        }
-
-        void check(Game& game, const Player& player){
-            if (this->currentCoordinates.x <= -1.15f){
-                this->SpriteTranslate(
-                    game.spriteCount*game.spriteDist
-                    , 0, 0);
 
-                this->genAgain();
+        // cycles the running textures while on the ground
+        void animate(float dt){
+            this->runningTime += dt;
+            if (this->runningTime > this->textureChangeTime){
+                this->runningTime = 0.0f;
+                this->playerRunningIndex++;
+                this->playerRunningIndex%=3;
             }
-
-            if (this->textureStyle == 1){
-                this->doVerticalTranslation();
-            }
-
-            this->checkCollision(game, player);
         }
 };
 
-class Coin: public Sprite{
-    public:
-        bool goingUpwards;
-        float verticalSpeed;
-        float translationProbability;
-        bool isExists;
-        float xBias;
-        float randGenFloat;
-
-        void genInitPos(){
-            float rand01 = rand() / static_cast<float>(RAND_MAX);
-            rand01 = 2*rand01 - 1;
-            rand01 *= 0.75;
-            this->currentCoordinates.y = rand01;
-
-            this->xBias = genRand(this->randGenFloat);
-            this->currentCoordinates.x += xBias;
-        }
-
-        Coin(glm::vec3 currentCoordinates){
-            this->enableSmoothstep = 0.0;
-
-            this->randGenFloat = 0.2;
-
-            this->currentCoordinates = currentCoordinates;
-            this->xBias = genRand(this->randGenFloat);
-            this->currentCoordinates.x += xBias;
-
-
-            this->SpriteModel = glm::mat4(1.0f);
-
-            this->genInitPos();
-
-            translate(this->SpriteModel, this->currentCoordinates.x,
-                this->currentCoordinates.y,
-                this->currentCoordinates.z);
-
-            this->translationProbability = rand() / static_cast<float>(RAND_MAX);
-            this->goingUpwards = true;
-            this->verticalSpeed = 0.0075f;
-            this->isExists = true;
-        }
-
-        void checkCollision(Game& game, const Player& player){
-            if (!isExists)
-                return;
-
-            float ellipseA = 0.03f;
-            float ellipseB = 0.1f;
-
-            float playerDistance = 
-                (player.currentCoordinates.x - 
-                    this->currentCoordinates.x) *
-                (player.currentCoordinates.x - 
-                    this->currentCoordinates.x)
-                /ellipseA   +
-                (player.currentCoordinates.y - 
-                    this->currentCoordinates.y) *
-                (player.currentCoordinates.y - 
-                    this->currentCoordinates.y)
-                /ellipseB;
-
-            if (playerDistance < 1){
-                game.score++;
-                this->isExists = false;
-            }
-        }
-
-        void genAgain(){
-            this->genInitPos();
-
-            this->SpriteModel = glm::mat4(1.0f);
-
-            translate(this->SpriteModel, this->currentCoordinates.x,
-                this->currentCoordinates.y,
-                this->currentCoordinates.z);
-
-            this->translationProbability = rand() / static_cast<float>(RAND_MAX);
-            this->isExists = true;
-        }
-
-        void doVerticalTranslation(){
-            if (this->goingUpwards){
-                this->SpriteTranslate(0, this->verticalSpeed, 0);
-            } else {
-                this->SpriteTranslate(0, -this->verticalSpeed, 0);
-            }
-
-            if (this->currentCoordinates.y >= 0.75){
-                this->goingUpwards = false;
-            } 
-            
-            if (this->currentCoordinates.y <= -0.75){
-                this->goingUpwards = true;
-            }
-        }
-
-        void check(Game& game, const Player& player){
-            if (this->currentCoordinates.x <= -1.15f){
-                this->SpriteTranslate(
-                    game.spriteCount*game.spriteDist
-                    , 0, 0);
-
-                this->currentCoordinates.x -= xBias;
-                this->genAgain();
-            }
-
-            if (this->translationProbability > 0.7)
-                this->doVerticalTranslation();
-
-            this->checkCollision(game, player);
-        }
-};
+void identify(glm::mat4& matrix);
 
 class levelChanger: public Sprite{
     public:
@@ -463,7 +223,7 @@ class levelChanger: public Sprite{
 
                 if (!this->levelChanged){
                     game.level++;
-                    if (game.level == 4){
+                    if (game.level == 4 && !game.endless){
                         game.level = 3;
                         game.isGameWon = true;
                     }
@@ -475,6 +235,7 @@ class levelChanger: public Sprite{
                 this->SpriteTranslate(
                     game.numSpritesPerLevel*game.spriteDist
                     , 0, 0);
+                this->snap();
                 this->levelChanged = false;
             }
         }